@@ -0,0 +1,189 @@
+/*
+ * conceptum.c
+ *
+ * libconceptum: the VM of vm.c behind the embedding API of conceptum.h.
+ * A program is loaded and prepared for the engine once; every call then runs one procedure on the resident
+ * stack, frames and globals. Errors that end the Conceptum executable end the call instead, see concept_exit().
+ * Copyright (C) Alex Fang <ruijief@acm.org> 2016
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+
+#include "vm.h"
+#include "reg.h"
+#include "jit.h"
+#include "tier.h"
+#include "conceptum.h"
+
+struct ConceptumVM {
+    int32_t engine; // CONCEPTUM_ENGINE_*, the same numbers as CONCEPT_TIER_*
+    BOOL loaded;
+    ConceptStack_t stack;
+    ConceptFrameStack_t frames;
+    ConceptValue_t *stack_bottom; // eval() shifts the stack's view per frame, an aborted call leaves it shifted
+    int32_t stack_size;
+};
+
+static ConceptumVM_t *conceptum_vm = NULL;
+
+// Release the program and everything of its runs: stack, frames, globals, heap, native code
+static void conceptum_unload(ConceptumVM_t *vm) {
+    tier_stop();
+    jit_release();
+    if (vm->loaded)
+        gc_shutdown();
+    unmap_prog(); // a source whose parse was aborted is still mapped
+    frame_stack_free(&vm->frames);
+    stack_free(&vm->stack);
+    arena_free(&run_arena);
+    cleanup();
+    vm->loaded = FALSE;
+}
+
+ConceptumVM_t *conceptum_create(int32_t engine) {
+    if (conceptum_vm != NULL || engine < CONCEPT_TIER_STACK || engine > CONCEPT_TIER_TIERED)
+        return NULL;
+    ConceptumVM_t *vm = calloc(1, sizeof(ConceptumVM_t));
+    if (vm == NULL)
+        return NULL;
+    vm->engine = engine;
+    conceptum_vm = vm;
+    return vm;
+}
+
+int32_t conceptum_load(ConceptumVM_t *vm, const char *path) {
+    conceptum_unload(vm);
+
+    jmp_buf jump;
+    int32_t status = setjmp(jump);
+    if (status != 0) {
+        concept_error_jump = NULL;
+        conceptum_unload(vm);
+        return status;
+    }
+    concept_error_jump = &jump;
+
+    stack_alloc(&vm->stack, CONCEPTFP_MAX_LENGTH);
+    frame_stack_alloc(&vm->frames, CONCEPTREC_MAX_LENGTH);
+    vm->stack_bottom = vm->stack.operand_stack;
+    vm->stack_size = vm->stack.size;
+    load_program((char *) path, vm->engine, &vm->stack, &vm->frames);
+
+    gc_start(&vm->stack);
+    vm->loaded = TRUE;
+    if (vm->engine == CONCEPT_TIER_TIERED)
+        tier_start(&vm->stack, &vm->frames, CONCEPT_TIER_THRESHOLD);
+
+    concept_error_jump = NULL;
+    return CONCEPTUM_OK;
+}
+
+int32_t conceptum_procedure(ConceptumVM_t *vm, const char *name) {
+    if (!vm->loaded)
+        return CONCEPTUM_NO_PROCEDURE;
+    for (int32_t p = 0; p < procedure_call_table_length; p++)
+        if (!strcmp(procedure_call_table[p], name))
+            return p;
+    return CONCEPTUM_NO_PROCEDURE;
+}
+
+int32_t conceptum_call(ConceptumVM_t *vm, int32_t procedure, const ConceptumValue_t *args, int32_t nargs,
+                       ConceptumValue_t *result) {
+    if (!vm->loaded)
+        return CONCEPTUM_NOT_LOADED;
+    if (procedure < 0 || procedure >= procedure_length_table_length)
+        return CONCEPTUM_NO_PROCEDURE;
+    if (nargs != procedure_args_table[procedure])
+        return CONCEPTUM_BAD_ARGUMENTS;
+
+    // the arguments become the entry procedure's first slots, exactly as if a caller had pushed them
+    vm->stack.top = -1;
+    for (int32_t a = 0; a < nargs; a++) {
+        ConceptValue_t v;
+        v.type = args[a].type;
+        switch (args[a].type) {
+            case CONCEPTUM_INT:
+            case CONCEPTUM_BOOL:
+                v.as.i = args[a].as.i;
+                break;
+            case CONCEPTUM_FLOAT:
+                v.as.f = args[a].as.f;
+                break;
+            case CONCEPTUM_CHAR:
+                v.as.c = args[a].as.c;
+                break;
+            case CONCEPTUM_STRING:
+                v.as.s = (char *) args[a].as.s;
+                break;
+            case CONCEPTUM_VOID:
+                v.as.v = NULL;
+                break;
+            default:
+                return CONCEPTUM_BAD_ARGUMENTS;
+        }
+        stack_push_fast(&vm->stack, v);
+    }
+
+    jmp_buf jump;
+    int32_t status = setjmp(jump);
+    if (status != 0) { // drop whatever the aborted call left on the stack and frames
+        concept_error_jump = NULL;
+        vm->stack.operand_stack = vm->stack_bottom;
+        vm->stack.size = vm->stack_size;
+        vm->stack.top = -1;
+        vm->frames.top = -1;
+        return status;
+    }
+    concept_error_jump = &jump;
+
+    ConceptValue_t ret;
+    if (vm->engine == CONCEPT_TIER_REGISTER || vm->engine == CONCEPT_TIER_JIT)
+        ret = reg_eval(procedure, &vm->stack, global_table, &vm->frames);
+    else
+        ret = eval(procedure, &vm->stack, global_table, &vm->frames, 0);
+    concept_error_jump = NULL;
+
+    if (result != NULL) {
+        result->type = ret.type;
+        switch (ret.type) {
+            case CONCEPT_VALUE_INT:
+            case CONCEPT_VALUE_BOOL:
+                result->as.i = ret.as.i;
+                break;
+            case CONCEPT_VALUE_FLOAT:
+                result->as.f = ret.as.f;
+                break;
+            case CONCEPT_VALUE_CHAR:
+                result->as.c = ret.as.c;
+                break;
+            case CONCEPT_VALUE_STRING:
+                result->as.s = ret.as.s;
+                break;
+            case CONCEPT_VALUE_OBJECT: // a heap string, the host does not see the difference
+                result->type = CONCEPTUM_STRING;
+                result->as.s = ret.as.o->data;
+                break;
+            default:
+                result->type = CONCEPTUM_VOID;
+                result->as.s = NULL;
+        }
+    }
+    return CONCEPTUM_OK;
+}
+
+int32_t conceptum_invoke(ConceptumVM_t *vm, const char *name, const ConceptumValue_t *args, int32_t nargs,
+                         ConceptumValue_t *result) {
+    if (!vm->loaded)
+        return CONCEPTUM_NOT_LOADED;
+    return conceptum_call(vm, conceptum_procedure(vm, name), args, nargs, result);
+}
+
+void conceptum_destroy(ConceptumVM_t *vm) {
+    if (vm == NULL)
+        return;
+    conceptum_unload(vm);
+    free(vm);
+    conceptum_vm = NULL;
+}
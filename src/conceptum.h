@@ -0,0 +1,112 @@
+/*
+ * conceptum.h
+ *
+ * Embedding API of libconceptum: load a program once, then call its procedures from the host
+ * Copyright (C) Alex Fang <ruijief@acm.org> 2016
+ */
+
+#ifndef CONCEPTUM_H_
+#define CONCEPTUM_H_
+
+#include <stdint.h>
+
+#if defined(__GNUC__)
+#define CONCEPTUM_API __attribute__((visibility("default")))
+#else
+#define CONCEPTUM_API
+#endif
+
+// Engines, as selected by the command line options of the Conceptum executable
+#define CONCEPTUM_ENGINE_STACK 0 // the stack interpreter
+#define CONCEPTUM_ENGINE_REGISTER 1 // --register
+#define CONCEPTUM_ENGINE_JIT 2 // --jit, the register interpreter where native code is not available
+#define CONCEPTUM_ENGINE_TIERED 3 // --tiered, hot procedures compiled on a background thread
+
+// Value types, the same tags the VM uses internally
+#define CONCEPTUM_VOID 0
+#define CONCEPTUM_INT 1
+#define CONCEPTUM_FLOAT 2
+#define CONCEPTUM_CHAR 3
+#define CONCEPTUM_BOOL 4
+#define CONCEPTUM_STRING 5
+
+// Status codes; any other nonzero status is the exit status the executable would have ended with,
+// and its message has been printed already
+#define CONCEPTUM_OK 0
+#define CONCEPTUM_NOT_LOADED (-1) // no program loaded yet
+#define CONCEPTUM_NO_PROCEDURE (-2) // no procedure by that name or index
+#define CONCEPTUM_BAD_ARGUMENTS (-3) // argument count differs from the procedure's args=
+
+// A value passed to or returned by a procedure. A returned string lives in the VM and stays valid until the
+// next call into it; a string argument has to stay valid for the duration of the call.
+typedef struct {
+    int32_t type;
+    union {
+        int32_t i; // also holds BOOL
+        float f;
+        char c;
+        const char *s;
+    } as;
+} ConceptumValue_t;
+
+// The VM keeps its program and heap in process-wide state, so only one exists at a time
+typedef struct ConceptumVM ConceptumVM_t;
+
+/**
+ * Create the VM. Returns NULL if one exists already or the engine is unknown.
+ *
+ * @param engine int32_t CONCEPTUM_ENGINE_*
+ * @return ConceptumVM_t*
+ */
+CONCEPTUM_API ConceptumVM_t *conceptum_create(int32_t engine);
+/**
+ * Load a .fng source file or a .fngc image, replacing the program loaded before. The program is verified and
+ * prepared for the VM's engine once; its globals start out void and keep their values from call to call.
+ * A failed load leaves no program loaded and releases everything it allocated.
+ *
+ * @param vm ConceptumVM_t*
+ * @param path const char*
+ * @return int32_t status
+ */
+CONCEPTUM_API int32_t conceptum_load(ConceptumVM_t *vm, const char *path);
+/**
+ * Index of the procedure called name, for conceptum_call(). Negative if there is none.
+ *
+ * @param vm ConceptumVM_t*
+ * @param name const char*
+ * @return int32_t
+ */
+CONCEPTUM_API int32_t conceptum_procedure(ConceptumVM_t *vm, const char *name);
+/**
+ * Run a procedure with nargs arguments and store its return value in result (may be NULL).
+ * A runtime error aborts the call and returns its status; the VM stays usable.
+ *
+ * @param vm ConceptumVM_t*
+ * @param procedure int32_t index from conceptum_procedure()
+ * @param args const ConceptumValue_t*
+ * @param nargs int32_t
+ * @param result ConceptumValue_t*
+ * @return int32_t status
+ */
+CONCEPTUM_API int32_t conceptum_call(ConceptumVM_t *vm, int32_t procedure, const ConceptumValue_t *args,
+                                     int32_t nargs, ConceptumValue_t *result);
+/**
+ * conceptum_call() by name. Looking the name up once with conceptum_procedure() is cheaper for repeated calls.
+ *
+ * @param vm ConceptumVM_t*
+ * @param name const char*
+ * @param args const ConceptumValue_t*
+ * @param nargs int32_t
+ * @param result ConceptumValue_t*
+ * @return int32_t status
+ */
+CONCEPTUM_API int32_t conceptum_invoke(ConceptumVM_t *vm, const char *name, const ConceptumValue_t *args,
+                                       int32_t nargs, ConceptumValue_t *result);
+/**
+ * Unload the program and release the VM.
+ *
+ * @param vm ConceptumVM_t*
+ * @return void
+ */
+CONCEPTUM_API void conceptum_destroy(ConceptumVM_t *vm);
+#endif
@@ -0,0 +1,146 @@
+// Copyright (c) Alex Fang. LICENSE included in gc.h header file.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gc.h"
+
+#define GC_ROUND(n) (((n) + 15) & ~(size_t) 15)
+#define GC_OBJECT_SIZE(size) GC_ROUND(sizeof(ConceptObject_t) + (size))
+
+static ConceptGcRoots_t gc_roots;
+
+// Nursery: [nursery, nursery_end), allocation bumps nursery_top
+static char *nursery;
+static char *nursery_top;
+static char *nursery_end;
+
+// Mature space: a list of individually allocated objects
+static ConceptObject_t *mature;
+static size_t mature_bytes;
+static size_t mature_limit;
+
+static void *gc_malloc(size_t size) {
+    void *mem = aligned_alloc(16, GC_ROUND(size));
+    if (mem == NULL) {
+        fprintf(stderr, "\n[CONCEPTUM-Runtime] Out of memory.\n");
+        exit(1);
+    }
+    return mem;
+}
+
+static inline int in_nursery(ConceptObject_t *o) {
+    return (char *) o >= nursery && (char *) o < nursery_end;
+}
+
+static ConceptObject_t *mature_alloc(uint8_t kind, size_t size) {
+    ConceptObject_t *o = gc_malloc(GC_OBJECT_SIZE(size));
+    o->size = (uint32_t) size;
+    o->kind = kind;
+    o->marked = 0;
+    o->forwarded = 0;
+    o->link = mature;
+    mature = o;
+    mature_bytes += GC_OBJECT_SIZE(size);
+    return o;
+}
+
+void gc_init(ConceptGcRoots_t roots) {
+    gc_roots = roots;
+    nursery = gc_malloc(CONCEPT_GC_NURSERY_SIZE);
+    nursery_top = nursery;
+    nursery_end = nursery + CONCEPT_GC_NURSERY_SIZE;
+    mature = NULL;
+    mature_bytes = 0;
+    mature_limit = CONCEPT_GC_MATURE_MIN;
+}
+
+// Minor collection: copy a nursery object into the mature space once, then redirect every slot to the copy.
+// Objects hold no references, so the roots are the only pointers into the nursery and no remembered set is needed.
+static void promote(ConceptObject_t **slot) {
+    ConceptObject_t *o = *slot;
+    if (!in_nursery(o))
+        return;
+    if (!o->forwarded) {
+        ConceptObject_t *copy = mature_alloc(o->kind, o->size);
+        memcpy(copy->data, o->data, o->size);
+        o->forwarded = 1;
+        o->link = copy;
+    }
+    *slot = o->link;
+}
+
+static void mark(ConceptObject_t **slot) {
+    (*slot)->marked = 1;
+}
+
+void gc_collect_minor() {
+#ifdef DEBUG
+    size_t before = mature_bytes;
+#endif
+    gc_roots(promote);
+    nursery_top = nursery;
+#ifdef DEBUG
+    printf("\nGC: minor collection, promoted %zu bytes\n", mature_bytes - before);
+#endif
+}
+
+void gc_collect_major() {
+    gc_collect_minor(); // every live object is mature now
+    gc_roots(mark);
+
+    ConceptObject_t **link = &mature;
+    while (*link != NULL) {
+        ConceptObject_t *o = *link;
+        if (o->marked) {
+            o->marked = 0;
+            link = &o->link;
+        } else {
+            *link = o->link;
+            mature_bytes -= GC_OBJECT_SIZE(o->size);
+            free(o);
+        }
+    }
+    mature_limit = mature_bytes * CONCEPT_GC_MATURE_FACTOR;
+    if (mature_limit < CONCEPT_GC_MATURE_MIN)
+        mature_limit = CONCEPT_GC_MATURE_MIN;
+#ifdef DEBUG
+    printf("\nGC: major collection, %zu bytes live\n", mature_bytes);
+#endif
+}
+
+ConceptObject_t *gc_alloc(uint8_t kind, size_t size) {
+    size_t need = GC_OBJECT_SIZE(size);
+    if (need > CONCEPT_GC_NURSERY_SIZE / 4) { // too big to be worth copying, born mature but still on the budget
+        if (mature_bytes + need > mature_limit)
+            gc_collect_major();
+        return mature_alloc(kind, size);
+    }
+
+    if ((size_t) (nursery_end - nursery_top) < need) {
+        if (mature_bytes + CONCEPT_GC_NURSERY_SIZE > mature_limit)
+            gc_collect_major();
+        else
+            gc_collect_minor();
+    }
+    ConceptObject_t *o = (ConceptObject_t *) nursery_top;
+    nursery_top += need;
+    o->size = (uint32_t) size;
+    o->kind = kind;
+    o->marked = 0;
+    o->forwarded = 0;
+    o->link = NULL;
+    return o;
+}
+
+void gc_shutdown() {
+    while (mature != NULL) {
+        ConceptObject_t *next = mature->link;
+        free(mature);
+        mature = next;
+    }
+    mature_bytes = 0;
+    free(nursery);
+    nursery = nursery_top = nursery_end = NULL;
+}
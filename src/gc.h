@@ -0,0 +1,74 @@
+/*
+ * gc.h
+ *
+ * Generational garbage collector for runtime heap objects
+ * Copyright (C) Alex Fang <ruijief@acm.org> 2016
+ */
+
+#ifndef GC_H_
+#define GC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Objects are born in the nursery, a bump-allocated region emptied by every minor collection.
+// Survivors of a minor collection are promoted to the mature space, which is marked and swept
+// once it has grown past CONCEPT_GC_MATURE_FACTOR times what survived the previous major collection.
+// Objects bigger than a quarter of the nursery are allocated in the mature space directly, against the same limit.
+#define CONCEPT_GC_NURSERY_SIZE (256 * 1024)
+#define CONCEPT_GC_MATURE_MIN (4 * 1024 * 1024)
+#define CONCEPT_GC_MATURE_FACTOR 2
+
+// Object kinds
+#define CONCEPT_OBJECT_STRING 1 // NUL-terminated characters in data[]
+
+typedef struct ConceptObject {
+    uint32_t size; // bytes in data[]
+    uint8_t kind;
+    uint8_t marked; // mature space: reached by the current major collection
+    uint8_t forwarded; // nursery: link points at the promoted copy
+    uint8_t reserved;
+    struct ConceptObject *link; // nursery: forwarding pointer, mature space: next object
+    _Alignas(16) char data[];
+} ConceptObject_t;
+
+// Called by the collector for every root slot holding an object; it may rewrite the slot
+typedef void (*ConceptGcVisitor_t)(ConceptObject_t **slot);
+// Supplied by the VM: visit every root (operand stack slots, frame slots, globals)
+typedef void (*ConceptGcRoots_t)(ConceptGcVisitor_t visit);
+
+/**
+ * Set up the nursery and the mature space.
+ *
+ * @param roots ConceptGcRoots_t the VM's root enumerator
+ * @return void
+ */
+void gc_init(ConceptGcRoots_t roots);
+/**
+ * Allocate an object with size bytes of data. May collect first, so every object the caller
+ * still needs has to be reachable from a root.
+ *
+ * @param kind uint8_t
+ * @param size size_t
+ * @return ConceptObject_t*
+ */
+ConceptObject_t *gc_alloc(uint8_t kind, size_t size);
+/**
+ * Promote the nursery's survivors and empty it.
+ *
+ * @return void
+ */
+void gc_collect_minor();
+/**
+ * Minor collection, then mark the mature space from the roots and sweep it.
+ *
+ * @return void
+ */
+void gc_collect_major();
+/**
+ * Release every object, reachable or not.
+ *
+ * @return void
+ */
+void gc_shutdown();
+#endif
@@ -0,0 +1,693 @@
+// Copyright (c) Ruijie Fang. LICENSE included in the project repository.
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "jit.h"
+#include "reg.h"
+#include "tier.h"
+
+/*
+ * Baseline JIT
+ * ------------
+ * jit_compile_procedures() turns the register code of every procedure into x86-64 machine code, one template per
+ * register instruction. The native frame is the procedure's register frame on the operand stack, addressed through
+ * rbx at offsets known when compiling, so nothing ever moves a stack pointer; constants become immediates, the last
+ * integer computed stays in eax for the next instruction, jumps are direct and calls between compiled procedures
+ * are plain call instructions. The opcodes without a register form call their stack handler.
+ * Everything is emitted into one buffer, copied into an executable mapping and released by jit_release().
+ * A procedure the emitter cannot compile stays NULL in jit_program and is interpreted by reg_eval().
+ */
+
+#ifdef CONCEPT_JIT
+
+// Errors raised from native code, see jit_error()
+#define CONCEPT_JIT_ERR_IADD 0
+#define CONCEPT_JIT_ERR_IMUL 1
+#define CONCEPT_JIT_ERR_IDIV 2
+#define CONCEPT_JIT_ERR_FADD 3
+#define CONCEPT_JIT_ERR_FMUL 4
+#define CONCEPT_JIT_ERR_FDIV 5
+#define CONCEPT_JIT_ERR_STACK 6
+#define CONCEPT_JIT_ERR_CALLS 7
+#define CONCEPT_JIT_ERR_HALT 8
+#define CONCEPT_JIT_ERR_COUNT 9
+
+// x86-64 registers used by the templates
+#define X86_RAX 0
+#define X86_RCX 1
+#define X86_RDX 2
+#define X86_RBX 3
+#define X86_RDI 7
+
+#define REG_OFFSET(r) ((int32_t) sizeof(ConceptValue_t) * (r))
+#define REG_VALUE_OFFSET(r) (REG_OFFSET(r) + (int32_t) offsetof(ConceptValue_t, as))
+
+// Executable mappings, one per jit_map()
+typedef struct ConceptJitRegion {
+    void *code;
+    size_t size;
+    struct ConceptJitRegion *next;
+} ConceptJitRegion_t;
+
+static ConceptJitRegion_t *jit_regions = NULL;
+
+// What native code needs from the run, fixed while it is compiled
+static ConceptStack_t *jit_stack;
+static ConceptFrameStack_t *jit_frames;
+static ConceptValue_t *jit_stack_bottom;
+static int32_t jit_stack_size;
+
+typedef struct {
+    unsigned char *code;
+    size_t length, capacity;
+    int32_t cached; // register whose integer value eax holds, -1 for none
+} ConceptJitBuffer_t;
+
+static void jit_byte(ConceptJitBuffer_t *b, unsigned char byte) {
+    if (b->length == b->capacity) {
+        size_t capacity = b->capacity ? b->capacity * 2 : 4096;
+        b->code = arena_grow(&scratch_arena, b->code, b->capacity, capacity);
+        b->capacity = capacity;
+    }
+    b->code[b->length++] = byte;
+}
+
+static void jit_bytes(ConceptJitBuffer_t *b, const char *bytes, size_t count) {
+    for (size_t k = 0; k < count; k++)
+        jit_byte(b, (unsigned char) bytes[k]);
+}
+
+static void jit_int32(ConceptJitBuffer_t *b, int32_t v) {
+    uint32_t u = (uint32_t) v;
+    for (int k = 0; k < 4; k++)
+        jit_byte(b, (unsigned char) (u >> (8 * k)));
+}
+
+static void jit_int64(ConceptJitBuffer_t *b, uint64_t v) {
+    for (int k = 0; k < 8; k++)
+        jit_byte(b, (unsigned char) (v >> (8 * k)));
+}
+
+static void jit_patch32(ConceptJitBuffer_t *b, size_t at, int32_t v) {
+    uint32_t u = (uint32_t) v;
+    for (int k = 0; k < 4; k++)
+        b->code[at + k] = (unsigned char) (u >> (8 * k));
+}
+
+// opcode bytes, then a ModRM byte addressing [base + disp32]
+static void jit_mem(ConceptJitBuffer_t *b, const char *opcode, size_t count, int32_t reg, int32_t base,
+                    int32_t disp) {
+    jit_bytes(b, opcode, count);
+    jit_byte(b, (unsigned char) (0x80 | (reg << 3) | base));
+    jit_int32(b, disp);
+}
+
+// the frame's registers are addressed through rbx
+static void jit_rbx(ConceptJitBuffer_t *b, const char *opcode, size_t count, int32_t reg, int32_t disp) {
+    jit_mem(b, opcode, count, reg, X86_RBX, disp);
+}
+
+// movabs reg, imm64
+static void jit_movabs(ConceptJitBuffer_t *b, int32_t reg, const void *p) {
+    jit_byte(b, 0x48);
+    jit_byte(b, (unsigned char) (0xB8 + reg));
+    jit_int64(b, (uint64_t) (uintptr_t) p);
+}
+
+// call a C function through rax
+static void jit_call_c(ConceptJitBuffer_t *b, const void *function) {
+    jit_movabs(b, X86_RAX, function);
+    jit_bytes(b, "\xFF\xD0", 2);
+    b->cached = -1;
+}
+
+// jcc or jmp with a 32-bit displacement, returning where the displacement goes
+static size_t jit_jump(ConceptJitBuffer_t *b, const char *opcode, size_t count) {
+    jit_bytes(b, opcode, count);
+    size_t at = b->length;
+    jit_int32(b, 0);
+    return at;
+}
+
+static void jit_jump_to(ConceptJitBuffer_t *b, const char *opcode, size_t count, size_t target) {
+    size_t at = jit_jump(b, opcode, count);
+    jit_patch32(b, at, (int32_t) ((int64_t) target - (int64_t) (at + 4)));
+}
+
+// Integer value of an operand into eax (reg 0) or ecx (reg 1)
+static void jit_load_int(ConceptJitBuffer_t *b, int32_t reg, int32_t operand, const ConceptValue_t *constants) {
+    if (operand < 0) {
+        jit_byte(b, (unsigned char) (0xB8 + reg));
+        jit_int32(b, constants[~operand].as.i);
+    } else if (operand == b->cached) {
+        if (reg != X86_RAX)
+            jit_bytes(b, "\x89\xC1", 2); // mov ecx, eax
+    } else {
+        jit_rbx(b, "\x8B", 1, reg, REG_VALUE_OFFSET(operand));
+    }
+    if (reg == X86_RAX)
+        b->cached = operand >= 0 ? operand : -1;
+}
+
+// Both operands of a binary instruction: a into eax, b into ecx. b first, loading a may evict the cached value.
+static void jit_load_pair(ConceptJitBuffer_t *b, const ConceptRegInstruction_t *in, const ConceptValue_t *constants) {
+    jit_load_int(b, X86_RCX, in->b, constants);
+    jit_load_int(b, X86_RAX, in->a, constants);
+}
+
+// Values are written and copied as two quadwords, so that a copy never reads back a narrower store
+static void jit_store_type(ConceptJitBuffer_t *b, int32_t dst, int32_t type) {
+    jit_rbx(b, "\x48\xC7", 2, 0, REG_OFFSET(dst)); // mov qword [rbx + dst], type
+    jit_int32(b, type);
+}
+
+// eax into a register as an integer of the given type
+static void jit_store_int(ConceptJitBuffer_t *b, int32_t dst, int32_t type) {
+    jit_store_type(b, dst, type);
+    jit_rbx(b, "\x48\x89", 2, X86_RAX, REG_VALUE_OFFSET(dst)); // mov [rbx + dst + 8], rax
+    b->cached = dst;
+}
+
+// Float value of an operand into xmm0 or xmm1
+static void jit_load_float(ConceptJitBuffer_t *b, int32_t xmm, int32_t operand, const ConceptValue_t *constants) {
+    if (operand < 0) {
+        int32_t bits;
+        memcpy(&bits, &constants[~operand].as.f, sizeof(bits));
+        jit_byte(b, 0xB8); // mov eax, bits
+        jit_int32(b, bits);
+        jit_bytes(b, "\x66\x0F\x6E", 3); // movd xmm, eax
+        jit_byte(b, (unsigned char) (0xC0 | (xmm << 3)));
+    } else {
+        jit_rbx(b, "\xF3\x0F\x10", 3, xmm, REG_VALUE_OFFSET(operand)); // movss
+    }
+    b->cached = -1;
+}
+
+// Copy a whole value between [src_base + src] and [dst_base + dst] through rdx
+static void jit_move(ConceptJitBuffer_t *b, int32_t dst_base, int32_t dst, int32_t src_base, int32_t src) {
+    for (int32_t half = 0; half < 16; half += 8) {
+        jit_mem(b, "\x48\x8B", 2, X86_RDX, src_base, src + half);
+        jit_mem(b, "\x48\x89", 2, X86_RDX, dst_base, dst + half);
+    }
+}
+
+// Copy an operand, a register or a constant, to [dst_base + dst]
+static void jit_move_operand(ConceptJitBuffer_t *b, int32_t dst_base, int32_t dst, int32_t operand,
+                             const ConceptValue_t *constants) {
+    if (operand >= 0) {
+        jit_move(b, dst_base, dst, X86_RBX, REG_OFFSET(operand));
+        return;
+    }
+    uint64_t bits = 0;
+    memcpy(&bits, &constants[~operand].as, sizeof(constants[~operand].as));
+    jit_mem(b, "\x48\xC7", 2, 0, dst_base, dst); // mov qword [dst], type
+    jit_int32(b, constants[~operand].type);
+    jit_bytes(b, "\x48\xBA", 2); // movabs rdx, bits
+    jit_int64(b, bits);
+    jit_mem(b, "\x48\x89", 2, X86_RDX, dst_base, dst + (int32_t) offsetof(ConceptValue_t, as));
+}
+
+static void jit_error(int32_t error) {
+    switch (error) {
+        case CONCEPT_JIT_ERR_IADD:
+            on_error(CONCEPT_BUFFER_OVERFLOW, "IADD Operation exceeds INT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                     CONCEPT_ABORT);
+            break;
+        case CONCEPT_JIT_ERR_IMUL:
+            on_error(CONCEPT_BUFFER_OVERFLOW, "IMUL Operation exceeds INT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                     CONCEPT_ABORT);
+            break;
+        case CONCEPT_JIT_ERR_IDIV:
+            on_error(CONCEPT_BUFFER_OVERFLOW, "IDIV Operation divides by zero or exceeds INT_MAX limit, Aborting...",
+                     CONCEPT_STATE_ERROR, CONCEPT_ABORT);
+            break;
+        case CONCEPT_JIT_ERR_FADD:
+            on_error(CONCEPT_BUFFER_OVERFLOW, "FADD Operation exceeds FLT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                     CONCEPT_ABORT);
+            break;
+        case CONCEPT_JIT_ERR_FMUL:
+            on_error(CONCEPT_BUFFER_OVERFLOW, "FMUL Operation exceeds FLT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                     CONCEPT_ABORT);
+            break;
+        case CONCEPT_JIT_ERR_FDIV:
+            on_error(CONCEPT_BUFFER_OVERFLOW, "FDIV Operation exceeds FLT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                     CONCEPT_ABORT);
+            break;
+        case CONCEPT_JIT_ERR_STACK:
+            on_error(CONCEPT_STACK_OVERFLOW, "Stack is full, operation abort.", CONCEPT_STATE_ERROR,
+                     CONCEPT_WARN_EXITNOW);
+            break;
+        case CONCEPT_JIT_ERR_CALLS:
+            on_error(CONCEPT_STACK_OVERFLOW, "Call stack is full, operation abort.", CONCEPT_STATE_ERROR,
+                     CONCEPT_WARN_EXITNOW);
+            break;
+        default:
+            on_error(CONCEPT_GENERAL_ERROR, " Exit by HALT.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    }
+}
+
+static void jit_empty_return() {
+    on_error(CONCEPT_GENERAL_ERROR, "Stack is empty. Returning a void value.", CONCEPT_STATE_INFO,
+             CONCEPT_WARN_NOEXIT);
+}
+
+// A compiled procedure calling one left to the interpreter. When tiering, the callee may have been compiled
+// since, and otherwise it is counted as eval() would.
+static void jit_call_interpreted(ConceptValue_t *regs, int32_t callee) {
+    ConceptJitProcedure_t native = atomic_load_explicit(&jit_program[callee], memory_order_acquire);
+    if (native != NULL) {
+        native(regs);
+        return;
+    }
+    jit_stack->operand_stack = jit_stack_bottom;
+    jit_stack->size = jit_stack_size;
+    jit_stack->top = (int32_t) (regs - jit_stack_bottom) + procedure_args_table[callee] - 1;
+    if (tier_threshold) {
+        if (++procedure_call_counts[callee] + procedure_backedge_counts[callee] == tier_threshold)
+            tier_request(callee);
+        regs[0] = eval(callee, jit_stack, global_table, jit_frames, 0);
+    } else {
+        regs[0] = reg_eval(callee, jit_stack, global_table, jit_frames);
+    }
+    if (profiling) { // back in compiled code
+        profile_procedure = CONCEPT_PROFILE_JIT;
+        profile_pc = -1;
+    }
+}
+
+// Register code the emitter has a template for
+static BOOL jit_supported(int32_t p) {
+    for (int32_t r = 0; r < reg_program_length[p]; r++)
+        if (reg_program[p][r].op < CONCEPT_REG_MOV || reg_program[p][r].op > CONCEPT_REG_TAILCALL)
+            return 0;
+    return 1;
+}
+
+typedef struct {
+    size_t at; // displacement to patch
+    int32_t target; // register code index, or callee
+} ConceptJitFixup_t;
+
+// Compile procedure p, returning its entry offset. Calls are left in *calls for when every entry is known; without
+// calls, p is compiled alone and calls what is published in jit_program by then. With osr, it receives the offset
+// of an entry for every stack instruction that starts a register code label, SIZE_MAX elsewhere.
+static size_t jit_procedure(ConceptJitBuffer_t *b, int32_t p, const size_t *errors, ConceptJitFixup_t **calls,
+                            int32_t *call_count, int32_t *call_capacity, size_t *osr) {
+    const ConceptRegInstruction_t *code = reg_program[p];
+    const ConceptValue_t *constants = reg_constants[p];
+    int32_t length = reg_program_length[p];
+    int32_t slots = FRAME_SLOTS(p);
+    int32_t registers = slots + procedure_max_depth_table[p];
+
+    size_t *offsets = arena_alloc(&scratch_arena, sizeof(size_t) * (length + 1));
+    BOOL *targets = scratch_calloc((size_t) length + 1, sizeof(BOOL));
+    ConceptJitFixup_t *jumps = arena_alloc(&scratch_arena, sizeof(ConceptJitFixup_t) * (length + 1));
+    int32_t jump_count = 0;
+    for (int32_t r = 0; r < length; r++)
+        if (code[r].op >= CONCEPT_REG_JMP && code[r].op <= CONCEPT_REG_JNGT)
+            targets[code[r].target] = 1;
+    if (osr != NULL) // entered from eval() with nothing in eax
+        for (int32_t i = 0; i < procedure_length_table[p]; i++)
+            if (reg_labels[p][i] >= 0)
+                targets[reg_labels[p][i]] = 1;
+
+    // prologue: push rbx; mov rbx, rdi; check the frame fits; void the registers that are not arguments
+    size_t entry = b->length;
+    jit_byte(b, 0x53);
+    jit_bytes(b, "\x48\x89\xFB", 3);
+    jit_rbx(b, "\x48\x8D", 2, X86_RAX, REG_OFFSET(registers)); // lea rax, [rbx + registers]
+    jit_movabs(b, X86_RCX, jit_stack_bottom + jit_stack_size);
+    jit_bytes(b, "\x48\x39\xC8", 3); // cmp rax, rcx
+    jit_jump_to(b, "\x0F\x87", 2, errors[CONCEPT_JIT_ERR_STACK]); // ja
+    if (procedure_args_table[p] < registers)
+        jit_bytes(b, "\x0F\x57\xC0", 3); // xorps xmm0, xmm0
+    for (int32_t r = procedure_args_table[p]; r < registers; r++)
+        jit_rbx(b, "\x0F\x11", 2, 0, REG_OFFSET(r));
+    b->cached = -1;
+
+    for (int32_t r = 0; r < length; r++) {
+        const ConceptRegInstruction_t *in = &code[r];
+        offsets[r] = b->length;
+        if (targets[r])
+            b->cached = -1;
+
+        switch (in->op) {
+            case CONCEPT_REG_MOV:
+                jit_move_operand(b, X86_RBX, REG_OFFSET(in->dst), in->a, constants);
+                if (in->dst == b->cached)
+                    b->cached = -1;
+                break;
+            case CONCEPT_REG_IADD:
+            case CONCEPT_REG_IMUL:
+                jit_load_pair(b, in, constants);
+                if (in->op == CONCEPT_REG_IADD)
+                    jit_bytes(b, "\x01\xC8", 2); // add eax, ecx
+                else
+                    jit_bytes(b, "\x0F\xAF\xC1", 3); // imul eax, ecx
+                jit_jump_to(b, "\x0F\x80", 2, errors[in->op == CONCEPT_REG_IADD ? CONCEPT_JIT_ERR_IADD
+                                                                                 : CONCEPT_JIT_ERR_IMUL]); // jo
+                jit_store_int(b, in->dst, CONCEPT_VALUE_INT);
+                break;
+            case CONCEPT_REG_IDIV: {
+                // a constant divisor needs only the checks it can fail
+                int32_t divisor = in->b < 0 ? constants[~in->b].as.i : 0;
+                jit_load_pair(b, in, constants);
+                if (in->b >= 0) {
+                    jit_bytes(b, "\x85\xC9", 2); // test ecx, ecx
+                    jit_jump_to(b, "\x0F\x84", 2, errors[CONCEPT_JIT_ERR_IDIV]); // jz
+                } else if (divisor == 0) {
+                    jit_jump_to(b, "\xE9", 1, errors[CONCEPT_JIT_ERR_IDIV]);
+                }
+                if (in->b >= 0 || divisor == -1) {
+                    jit_byte(b, 0x3D); // cmp eax, INT32_MIN
+                    jit_int32(b, INT32_MIN);
+                    jit_bytes(b, "\x75\x09", 2); // jne over the next two
+                    jit_bytes(b, "\x83\xF9\xFF", 3); // cmp ecx, -1
+                    jit_jump_to(b, "\x0F\x84", 2, errors[CONCEPT_JIT_ERR_IDIV]); // je
+                }
+                jit_bytes(b, "\x99\xF7\xF9", 3); // cdq; idiv ecx
+                jit_store_int(b, in->dst, CONCEPT_VALUE_INT);
+                break;
+            }
+            case CONCEPT_REG_FADD:
+            case CONCEPT_REG_FMUL:
+            case CONCEPT_REG_FDIV: {
+                jit_load_float(b, 0, in->a, constants);
+                jit_load_float(b, 1, in->b, constants);
+                int32_t error = CONCEPT_JIT_ERR_FADD;
+                if (in->op == CONCEPT_REG_FADD)
+                    jit_bytes(b, "\xF3\x0F\x58\xC1", 4); // addss xmm0, xmm1
+                else if (in->op == CONCEPT_REG_FMUL)
+                    jit_bytes(b, "\xF3\x0F\x59\xC1", 4), error = CONCEPT_JIT_ERR_FMUL; // mulss
+                else
+                    jit_bytes(b, "\xF3\x0F\x5E\xC1", 4), error = CONCEPT_JIT_ERR_FDIV; // divss
+                // not finite: the magnitude bits exceed FLT_MAX's
+                jit_bytes(b, "\x66\x0F\x7E\xC0", 4); // movd eax, xmm0
+                jit_byte(b, 0x25); // and eax, 0x7fffffff
+                jit_int32(b, 0x7fffffff);
+                jit_byte(b, 0x3D); // cmp eax, bits of FLT_MAX
+                jit_int32(b, 0x7f7fffff);
+                jit_jump_to(b, "\x0F\x87", 2, errors[error]); // ja
+                jit_store_type(b, in->dst, CONCEPT_VALUE_FLOAT);
+                jit_rbx(b, "\x66\x0F\xD6", 3, 0, REG_VALUE_OFFSET(in->dst)); // movq [rbx + dst + 8], xmm0
+                b->cached = -1;
+                break;
+            }
+            case CONCEPT_REG_ILT:
+            case CONCEPT_REG_IEQ:
+            case CONCEPT_REG_IGT:
+                jit_load_pair(b, in, constants);
+                jit_bytes(b, "\x39\xC8\x0F", 3); // cmp eax, ecx; setcc al
+                jit_byte(b, in->op == CONCEPT_REG_ILT ? 0x9C : in->op == CONCEPT_REG_IEQ ? 0x94 : 0x9F);
+                jit_bytes(b, "\xC0\x0F\xB6\xC0", 4); // movzx eax, al
+                jit_store_int(b, in->dst, CONCEPT_VALUE_BOOL);
+                break;
+            case CONCEPT_REG_INC:
+            case CONCEPT_REG_DEC:
+                if (in->a != in->dst)
+                    jit_move_operand(b, X86_RBX, REG_OFFSET(in->dst), in->a, constants);
+                if (in->dst == b->cached)
+                    b->cached = -1;
+                // add/sub dword [rbx + dst], 1: in place, the type stays
+                jit_rbx(b, "\x83", 1, in->op == CONCEPT_REG_INC ? 0 : 5, REG_VALUE_OFFSET(in->dst));
+                jit_byte(b, 1);
+                break;
+            case CONCEPT_REG_GLOAD:
+                jit_movabs(b, X86_RAX, &global_table);
+                jit_bytes(b, "\x48\x8B\x00", 3); // mov rax, [rax]
+                jit_move(b, X86_RBX, REG_OFFSET(in->dst), X86_RAX, REG_OFFSET(in->target));
+                b->cached = -1;
+                break;
+            case CONCEPT_REG_GSTORE:
+                jit_movabs(b, X86_RAX, &global_table);
+                jit_bytes(b, "\x48\x8B\x00", 3); // mov rax, [rax]
+                jit_move_operand(b, X86_RAX, REG_OFFSET(in->target), in->a, constants);
+                b->cached = -1;
+                break;
+            case CONCEPT_REG_JMP:
+                jumps[jump_count++] = (ConceptJitFixup_t) {jit_jump(b, "\xE9", 1), in->target};
+                break;
+            case CONCEPT_REG_JF:
+                jit_load_int(b, X86_RAX, in->a, constants);
+                jit_bytes(b, "\x85\xC0", 2); // test eax, eax
+                jumps[jump_count++] = (ConceptJitFixup_t) {jit_jump(b, "\x0F\x84", 2), in->target}; // jz
+                break;
+            case CONCEPT_REG_JNLT:
+            case CONCEPT_REG_JNEQ:
+            case CONCEPT_REG_JNGT:
+                jit_load_pair(b, in, constants);
+                jit_bytes(b, "\x39\xC8", 2); // cmp eax, ecx
+                jumps[jump_count++] = (ConceptJitFixup_t) {
+                        jit_jump(b, in->op == CONCEPT_REG_JNLT ? "\x0F\x8D" : in->op == CONCEPT_REG_JNEQ ? "\x0F\x85"
+                                                                                                         : "\x0F\x8E",
+                                 2), in->target}; // jge, jne, jle
+                break;
+            case CONCEPT_REG_CALL:
+                // the call depth is counted in the frame stack like the interpreter's calls
+                jit_movabs(b, X86_RAX, &jit_frames->top);
+                jit_bytes(b, "\x8B\x08\x81\xF9", 4); // mov ecx, [rax]; cmp ecx, size - 1
+                jit_int32(b, jit_frames->size - 1);
+                jit_jump_to(b, "\x0F\x8D", 2, errors[CONCEPT_JIT_ERR_CALLS]); // jge
+                jit_bytes(b, "\xFF\x00", 2); // inc dword [rax]
+                if (profile_path != NULL) { // p's record as the caller, which only the profiler reads
+                    jit_bytes(b, "\xFF\xC1\x69\xC9", 4); // inc ecx; imul ecx, ecx, sizeof(ConceptFrame_t)
+                    jit_int32(b, (int32_t) sizeof(ConceptFrame_t));
+                    jit_movabs(b, X86_RDX, jit_frames->frames);
+                    jit_bytes(b, "\x48\x01\xCA", 3); // add rdx, rcx
+                    jit_mem(b, "\xC7", 1, 0, X86_RDX, (int32_t) offsetof(ConceptFrame_t, procedure)); // mov dword
+                    jit_int32(b, p);
+                }
+                jit_rbx(b, "\x48\x8D", 2, X86_RDI, REG_OFFSET(in->dst)); // lea rdi, [rbx + dst]
+                if (calls == NULL) {
+                    ConceptJitProcedure_t native = atomic_load_explicit(&jit_program[in->target],
+                                                                        memory_order_acquire);
+                    if (in->target == p) {
+                        jit_jump_to(b, "\xE8", 1, entry);
+                    } else if (native != NULL) {
+                        jit_call_c(b, (const void *) native);
+                    } else {
+                        jit_byte(b, 0xBE); // mov esi, callee
+                        jit_int32(b, in->target);
+                        jit_call_c(b, jit_call_interpreted);
+                    }
+                } else if (jit_supported(in->target)) {
+                    if (*call_count == *call_capacity) {
+                        int32_t capacity = *call_capacity ? *call_capacity * 2 : 16;
+                        *calls = arena_grow(&scratch_arena, *calls, sizeof(ConceptJitFixup_t) * *call_capacity,
+                                            sizeof(ConceptJitFixup_t) * capacity);
+                        *call_capacity = capacity;
+                    }
+                    (*calls)[(*call_count)++] = (ConceptJitFixup_t) {jit_jump(b, "\xE8", 1), in->target};
+                } else {
+                    jit_byte(b, 0xBE); // mov esi, callee
+                    jit_int32(b, in->target);
+                    jit_call_c(b, jit_call_interpreted);
+                }
+                jit_movabs(b, X86_RAX, &jit_frames->top);
+                jit_bytes(b, "\xFF\x08", 2); // dec dword [rax]
+                b->cached = -1;
+                break;
+            case CONCEPT_REG_TAILCALL:
+                // arguments down to the frame's base, then leave for the callee with rdi = rbx
+                for (int32_t arg = 0; arg < procedure_args_table[in->target]; arg++)
+                    jit_move(b, X86_RBX, REG_OFFSET(arg), X86_RBX, REG_OFFSET(in->dst + arg));
+                jit_bytes(b, "\x48\x89\xDF", 3); // mov rdi, rbx
+                if (calls == NULL) {
+                    ConceptJitProcedure_t native = atomic_load_explicit(&jit_program[in->target],
+                                                                        memory_order_acquire);
+                    if (in->target == p || native != NULL) {
+                        jit_byte(b, 0x5B); // pop rbx
+                        if (in->target == p) {
+                            jit_jump_to(b, "\xE9", 1, entry);
+                        } else {
+                            jit_movabs(b, X86_RAX, (const void *) native);
+                            jit_bytes(b, "\xFF\xE0", 2); // jmp rax
+                        }
+                        break;
+                    }
+                } else if (jit_supported(in->target)) {
+                    jit_byte(b, 0x5B); // pop rbx
+                    if (*call_count == *call_capacity) {
+                        int32_t capacity = *call_capacity ? *call_capacity * 2 : 16;
+                        *calls = arena_grow(&scratch_arena, *calls, sizeof(ConceptJitFixup_t) * *call_capacity,
+                                            sizeof(ConceptJitFixup_t) * capacity);
+                        *call_capacity = capacity;
+                    }
+                    (*calls)[(*call_count)++] = (ConceptJitFixup_t) {jit_jump(b, "\xE9", 1), in->target};
+                    break;
+                }
+                // an interpreted callee: call it on this frame and return what it leaves
+                jit_byte(b, 0xBE); // mov esi, callee
+                jit_int32(b, in->target);
+                jit_call_c(b, jit_call_interpreted);
+                jit_bytes(b, "\x5B\xC3", 2); // pop rbx; ret
+                break;
+            case CONCEPT_REG_RET:
+            case CONCEPT_REG_RETV:
+                if (in->op == CONCEPT_REG_RET) {
+                    if (in->a != 0)
+                        jit_move_operand(b, X86_RBX, 0, in->a, constants);
+                } else {
+                    jit_call_c(b, jit_empty_return);
+                    jit_store_type(b, 0, CONCEPT_VALUE_VOID);
+                    jit_rbx(b, "\x48\xC7", 2, 0, REG_VALUE_OFFSET(0)); // mov qword [rbx + 8], 0
+                    jit_int32(b, 0);
+                }
+                jit_bytes(b, "\x5B\xC3", 2); // pop rbx; ret
+                break;
+            case CONCEPT_REG_PRINT:
+                if (in->a < 0)
+                    jit_movabs(b, X86_RDI, &constants[~in->a]);
+                else
+                    jit_rbx(b, "\x48\x8D", 2, X86_RDI, REG_OFFSET(in->a));
+                jit_call_c(b, print_value);
+                break;
+            case CONCEPT_REG_STACK:
+                // the handler sees this frame's operands up to the instruction's depth, as does the collector
+                jit_movabs(b, X86_RAX, jit_stack);
+                jit_rbx(b, "\x48\x8D", 2, X86_RCX, REG_OFFSET(slots)); // lea rcx, [rbx + slots]
+                jit_bytes(b, "\x48\x89\x88", 3); // mov [rax + operand_stack], rcx
+                jit_int32(b, (int32_t) offsetof(ConceptStack_t, operand_stack));
+                jit_bytes(b, "\xC7\x80", 2); // mov dword [rax + top], depth - 1
+                jit_int32(b, (int32_t) offsetof(ConceptStack_t, top));
+                jit_int32(b, in->dst - 1);
+                jit_bytes(b, "\x48\x89\xC7", 3); // mov rdi, rax
+                jit_call_c(b, concept_opcodes[in->target].handler);
+                break;
+            case CONCEPT_REG_HALT:
+                jit_jump_to(b, "\xE9", 1, errors[CONCEPT_JIT_ERR_HALT]);
+                break;
+        }
+    }
+    for (int32_t j = 0; j < jump_count; j++)
+        jit_patch32(b, jumps[j].at, (int32_t) ((int64_t) offsets[jumps[j].target] - (int64_t) (jumps[j].at + 4)));
+
+    // loop entries: push rbx; mov rbx, rdi; jmp into the body. The frame was checked and set up by eval().
+    for (int32_t i = 0; osr != NULL && i < procedure_length_table[p]; i++) {
+        osr[i] = SIZE_MAX;
+        if (reg_labels[p][i] < 0)
+            continue;
+        osr[i] = b->length;
+        jit_byte(b, 0x53);
+        jit_bytes(b, "\x48\x89\xFB", 3);
+        jit_jump_to(b, "\xE9", 1, offsets[reg_labels[p][i]]);
+    }
+    return entry;
+}
+
+// Shared error exits, jumped to with the stack aligned for a call: mov edi, error; call jit_error
+static void jit_error_exits(ConceptJitBuffer_t *b, size_t *errors) {
+    for (int32_t e = 0; e < CONCEPT_JIT_ERR_COUNT; e++) {
+        errors[e] = b->length;
+        jit_byte(b, 0xBF);
+        jit_int32(b, e);
+        jit_call_c(b, jit_error);
+    }
+}
+
+// Copy the buffer into an executable mapping, NULL if there is none to be had.
+// Write, then execute: the mapping is never writable and executable at once.
+static char *jit_map(ConceptJitBuffer_t *b) {
+    void *code = mmap(NULL, b->length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) {
+        on_error(CONCEPT_GENERAL_ERROR, "Cannot map JIT code, interpreting instead.", CONCEPT_STATE_WARNING,
+                 CONCEPT_WARN_NOEXIT);
+        return NULL;
+    }
+    memcpy(code, b->code, b->length);
+    mprotect(code, b->length, PROT_READ | PROT_EXEC);
+    ConceptJitRegion_t *region = malloc(sizeof(ConceptJitRegion_t));
+    region->code = code;
+    region->size = b->length;
+    region->next = jit_regions;
+    jit_regions = region;
+#ifdef DEBUG
+    printf("\nJIT: %zu bytes of native code\n", b->length);
+#endif
+    return code;
+}
+
+// What native code refers to: the run's stack and frames
+void jit_attach(ConceptStack_t *stack, ConceptFrameStack_t *frames) {
+    jit_stack = stack;
+    jit_frames = frames;
+    jit_stack_bottom = stack->operand_stack;
+    jit_stack_size = stack->size;
+}
+
+// Compile every procedure for a run on the given stack and frames
+void jit_compile_procedures(ConceptStack_t *stack, ConceptFrameStack_t *frames) {
+    jit_attach(stack, frames);
+
+    ConceptJitBuffer_t b = {NULL, 0, 0, -1};
+    size_t errors[CONCEPT_JIT_ERR_COUNT];
+    jit_error_exits(&b, errors);
+
+    size_t *entries = arena_alloc(&scratch_arena, sizeof(size_t) * procedure_length_table_length);
+    ConceptJitFixup_t *calls = NULL;
+    int32_t call_count = 0, call_capacity = 0;
+    for (int32_t p = 0; p < procedure_length_table_length; p++)
+        if (jit_supported(p))
+            entries[p] = jit_procedure(&b, p, errors, &calls, &call_count, &call_capacity, NULL);
+    for (int32_t c = 0; c < call_count; c++)
+        jit_patch32(&b, calls[c].at, (int32_t) ((int64_t) entries[calls[c].target] - (int64_t) (calls[c].at + 4)));
+
+    char *code = jit_map(&b);
+    if (code != NULL) {
+        jit_program = arena_alloc(&program_arena, sizeof(ConceptJitProcedure_t) * procedure_length_table_length);
+        for (int32_t p = 0; p < procedure_length_table_length; p++)
+            jit_program[p] = jit_supported(p) ? (ConceptJitProcedure_t) (code + entries[p]) : NULL;
+    }
+}
+
+// Compile procedure p alone into its own mapping and publish it, its entries at jump targets allocated from arena.
+// Its register code has to be there; FALSE when the emitter has no template for it or there is no mapping.
+BOOL jit_compile_procedure(int32_t p, ConceptArena_t *arena) {
+    if (!jit_supported(p))
+        return 0;
+    ConceptJitBuffer_t b = {NULL, 0, 0, -1};
+    size_t errors[CONCEPT_JIT_ERR_COUNT];
+    jit_error_exits(&b, errors);
+    size_t *osr = arena_alloc(&scratch_arena, sizeof(size_t) * (procedure_length_table[p] + 1));
+    size_t entry = jit_procedure(&b, p, errors, NULL, NULL, NULL, osr);
+
+    char *code = jit_map(&b);
+    if (code == NULL)
+        return 0;
+    ConceptJitProcedure_t *entries = arena_alloc(arena,
+                                                 sizeof(ConceptJitProcedure_t) * (procedure_length_table[p] + 1));
+    for (int32_t i = 0; i < procedure_length_table[p]; i++)
+        entries[i] = osr[i] != SIZE_MAX ? (ConceptJitProcedure_t) (code + osr[i]) : NULL;
+    atomic_store_explicit(&jit_osr[p], entries, memory_order_release);
+    atomic_store_explicit(&jit_program[p], (ConceptJitProcedure_t) (code + entry), memory_order_release);
+    return 1;
+}
+
+// Unmap the native code, it refers to the run's stack and frames
+void jit_release() {
+    while (jit_regions != NULL) {
+        ConceptJitRegion_t *next = jit_regions->next;
+        munmap(jit_regions->code, jit_regions->size);
+        free(jit_regions);
+        jit_regions = next;
+    }
+    jit_program = NULL;
+    jit_osr = NULL;
+}
+#else
+void jit_compile_procedures(ConceptStack_t *stack, ConceptFrameStack_t *frames) {
+    (void) stack;
+    (void) frames;
+}
+
+void jit_release() {
+}
+#endif
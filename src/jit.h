@@ -0,0 +1,45 @@
+/*
+ * jit.h
+ *
+ * Baseline JIT: x86-64 machine code from the register code of reg.h, one template per register instruction
+ * Copyright (c) 2016 Ruijie Fang <ruijief@acm.org>
+ */
+
+#ifndef JIT_H_
+#define JIT_H_
+
+#include "vm.h"
+
+/**
+ * Bind native code to the run's stack and frames, which it addresses directly.
+ *
+ * @param stack ConceptStack_t*
+ * @param frames ConceptFrameStack_t*
+ * @return void
+ */
+void jit_attach(ConceptStack_t *stack, ConceptFrameStack_t *frames);
+/**
+ * Compile every translated procedure for a run on the given stack and frames and fill in jit_program.
+ * Without CONCEPT_JIT nothing is compiled and everything is interpreted.
+ *
+ * @param stack ConceptStack_t*
+ * @param frames ConceptFrameStack_t*
+ * @return void
+ */
+void jit_compile_procedures(ConceptStack_t *stack, ConceptFrameStack_t *frames);
+/**
+ * Compile translated procedure p alone into its own mapping and publish it in jit_program and jit_osr, which have
+ * to be allocated already. Its entries at jump targets are allocated from arena.
+ *
+ * @param p int32_t
+ * @param arena ConceptArena_t*
+ * @return BOOL FALSE when the emitter has no template for p or no executable memory is to be had
+ */
+BOOL jit_compile_procedure(int32_t p, ConceptArena_t *arena);
+/**
+ * Unmap the native code, it refers to the run's stack and frames.
+ *
+ * @return void
+ */
+void jit_release();
+#endif
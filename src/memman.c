@@ -1,67 +1,72 @@
-
 // Copyright (c) Alex Fang. LICENSE included in memman.h header file.
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <memory.h>
-#include <ctype.h>
+#include <string.h>
 
 #include "memman.h"
-#define FIRSTRUN_STACK_DEPTH 50
 
-void **reg;
-int firstrun = 1;
+ConceptArena_t program_arena = {NULL, NULL};
+ConceptArena_t run_arena = {NULL, NULL};
+_Thread_local ConceptArena_t scratch_arena = {NULL, NULL};
 
-// Global malloc() register
-void memreg(void *ptr) {
-    if(firstrun) {
-        firstrun = 0;
-        reg = malloc(sizeof(void*)*FIRSTRUN_STACK_DEPTH);
-        return;
-    }
+#define ARENA_ROUND(n) (((n) + (CONCEPT_ARENA_ALIGN - 1)) & ~(size_t) (CONCEPT_ARENA_ALIGN - 1))
 
-    if(sizeof(reg) > sizeof(void*)*FIRSTRUN_STACK_DEPTH) {
-        void **newreg = malloc(sizeof(reg) + sizeof(void *)); // a growing stack
-        newreg = reg;
-        newreg[(sizeof(newreg) / sizeof(void *)) - 1] = ptr;
-        free(reg);
-        reg = newreg;
+// Chain a new block big enough for size, at least twice the current one
+static ConceptArenaBlock_t *arena_new_block(ConceptArena_t *arena, size_t size) {
+    size_t block_size = arena->head ? arena->head->size * 2 : CONCEPT_ARENA_BLOCK_SIZE;
+    while (block_size < size)
+        block_size *= 2;
+    ConceptArenaBlock_t *block = malloc(sizeof(ConceptArenaBlock_t) + block_size);
+    if (block == NULL) {
+        fprintf(stderr, "\n[CONCEPTUM-Runtime] Out of memory.\n");
+        exit(1);
     }
+    block->prev = arena->head;
+    block->size = block_size;
+    block->used = 0;
+    arena->head = block;
+    return block;
 }
 
-// Global deallocator for all dynamic memory
-void memfree() {
-    for(int i = 0; i < (sizeof(reg) / sizeof(void *)); i++) {
-        free(reg[i]);
-    }
-
-    free(reg);
+void *arena_alloc(ConceptArena_t *arena, size_t size) {
+    size = ARENA_ROUND(size ? size : 1);
+    ConceptArenaBlock_t *block = arena->head;
+    if (block == NULL || block->size - block->used < size)
+        block = arena_new_block(arena, size);
+    void *mem = block->data + block->used;
+    block->used += size;
+    arena->last = mem;
+    return mem;
 }
 
-// wrapper function(s)
+void *arena_grow(ConceptArena_t *arena, void *ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL)
+        return arena_alloc(arena, new_size);
+    if (new_size <= old_size)
+        return ptr;
 
-void* rmalloc(size_t size) {
-    void *mem = malloc(size);
-    memreg(mem);
+    // the newest allocation can just move the bump pointer
+    ConceptArenaBlock_t *block = arena->head;
+    if (ptr == arena->last) {
+        size_t offset = (size_t) ((unsigned char *) ptr - block->data);
+        if (block->size - offset >= ARENA_ROUND(new_size)) {
+            block->used = offset + ARENA_ROUND(new_size);
+            return ptr;
+        }
+    }
+    void *mem = arena_alloc(arena, new_size);
+    memcpy(mem, ptr, old_size);
     return mem;
 }
 
-void rfree(void *ptr) {
-    for (int i = 0; i < (sizeof(reg) / sizeof(void *)); i++) {
-        if (reg[i] == ptr) {
-            void **newreg = malloc(sizeof(reg) - sizeof(void *));
-            for (int i = 0; i < sizeof(reg) / sizeof(void *); i++) {
-                if (reg[i] != ptr) newreg[i] = reg[i];
-            }
-            free(reg);
-            reg = newreg;
-        }
+void arena_free(ConceptArena_t *arena) {
+    ConceptArenaBlock_t *block = arena->head;
+    while (block != NULL) {
+        ConceptArenaBlock_t *prev = block->prev;
+        free(block);
+        block = prev;
     }
-    free(ptr);
+    arena->head = NULL;
+    arena->last = NULL;
 }
-
-void* rrealloc(void *ptr, size_t size) {
-    ptr = realloc(ptr, size);
-    memreg(ptr);
-    return ptr;
-}
\ No newline at end of file
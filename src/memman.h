@@ -1,7 +1,7 @@
 /*
  * memman.h
  *
- * Dynamic Memory Management and GC
+ * Dynamic Memory Management: bump-pointer arenas
  * Copyright (C) Alex Fang <ruijief@acm.org> 2016
  */
 
@@ -10,32 +10,55 @@
 
 #include <stdlib.h>
 
+// Every allocation is aligned to this
+#define CONCEPT_ARENA_ALIGN 16
+// Size of the first block of an arena, later blocks double
+#define CONCEPT_ARENA_BLOCK_SIZE (64 * 1024)
+
+typedef struct ConceptArenaBlock {
+    struct ConceptArenaBlock *prev;
+    size_t size; // usable bytes in data[]
+    size_t used;
+    _Alignas(CONCEPT_ARENA_ALIGN) unsigned char data[];
+} ConceptArenaBlock_t;
+
+// A region: allocations are carved off the newest block and only ever released all at once.
+typedef struct {
+    ConceptArenaBlock_t *head; // newest block, NULL while empty
+    void *last; // most recent allocation, the only one that can grow in place
+} ConceptArena_t;
+
+// Parsed code, constants, procedure tables: lives until the program is unloaded
+extern ConceptArena_t program_arena;
+// Operand stack, frames, globals: lives for one run of the program
+extern ConceptArena_t run_arena;
+// Parser, verifier, optimizer and compiler work buffers: lives for one load, one per thread
+extern _Thread_local ConceptArena_t scratch_arena;
+
 /**
+ * Allocate from a region. Never returns NULL.
  *
- * @param ptr void*
- * @return void
- */
-void memreg(void *ptr);
-/**
- * @return void
- */
-void memfree();
-/**
- *
+ * @param arena ConceptArena_t*
  * @param size size_t
  * @return void*
  */
-void* rmalloc(size_t size);
+void *arena_alloc(ConceptArena_t *arena, size_t size);
 /**
+ * Grow an allocation, in place if it is the region's most recent one, otherwise by copying.
  *
- * @param ptr void*
- * @reutrn void
+ * @param arena ConceptArena_t*
+ * @param ptr void* allocation from arena, or NULL
+ * @param old_size size_t
+ * @param new_size size_t
+ * @return void*
  */
-void rfree(void *ptr);
+void *arena_grow(ConceptArena_t *arena, void *ptr, size_t old_size, size_t new_size);
 /**
+ * Release everything allocated from a region. Blocks double in size, so this touches
+ * O(log n) blocks and never individual objects.
  *
- * @param ptr void*
- * @return void*
+ * @param arena ConceptArena_t*
+ * @return void
  */
-void* rrealloc(void *ptr, size_t size);
-#endif
\ No newline at end of file
+void arena_free(ConceptArena_t *arena);
+#endif
@@ -0,0 +1,96 @@
+/*
+ * opcodes.h
+ *
+ * Opcode descriptor table of the Conceptum instruction set
+ * Copyright (C) Alex Fang <ruijief@acm.org> 2016
+ */
+
+#ifndef OPCODES_H_
+#define OPCODES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Payload kinds, i.e. how the parameter of an instruction is parsed
+#define CONCEPT_PAYLOAD_NONE 0
+#define CONCEPT_PAYLOAD_CHAR 1
+#define CONCEPT_PAYLOAD_INT 2
+#define CONCEPT_PAYLOAD_FLOAT 3
+#define CONCEPT_PAYLOAD_BOOL 4
+#define CONCEPT_PAYLOAD_STRING 5
+#define CONCEPT_PAYLOAD_TARGET 6 // instruction index inside the procedure
+#define CONCEPT_PAYLOAD_PROCEDURE 7 // procedure name, resolved to its index
+#define CONCEPT_PAYLOAD_LOCAL 8 // index of an argument or local slot of the frame
+#define CONCEPT_PAYLOAD_GLOBAL 9 // global name, resolved to its index in the global table
+
+/*
+ * Comceptum Instruction set
+ */
+enum {
+#define CONCEPT_OPCODE(name, mnemonic, code, payload, pops, pushes, handler) CONCEPT_##name = code,
+#include "opcodes.def"
+};
+
+// Reserved, not implemented yet
+#define CONCEPT_SHIFTL 137
+#define CONCEPT_SHIFTR 138
+#define CONCEPT_TER 139
+
+#define CONCEPT_OPCODE_MAX 154 // one past the largest opcode
+
+struct ConceptStack;
+typedef void (*ConceptHandler_t)(struct ConceptStack *stack);
+
+// Opcode descriptor
+typedef struct {
+    const char *mnemonic; // NULL for unused codes
+    int32_t code;
+    int32_t payload;
+    int32_t pops;
+    int32_t pushes;
+    ConceptHandler_t handler;
+    int32_t length; // instructions covered, 2 for superinstructions
+} ConceptOpcode_t;
+
+// Slot of the generated perfect hash table
+typedef struct {
+    const char *mnemonic;
+    int16_t code; // -1 for empty slots
+} ConceptOpcodeSlot_t;
+
+// Descriptor table indexed by opcode
+extern const ConceptOpcode_t concept_opcodes[CONCEPT_OPCODE_MAX];
+// First half of each superinstruction, 0 for everything else
+extern const int32_t concept_super_first[CONCEPT_OPCODE_MAX];
+
+// The opcode an instruction has without fusion: the second half of a pair is still in place after it
+#define PLAIN_OPCODE(instr) \
+    ((instr) >= 0 && (instr) < CONCEPT_OPCODE_MAX && concept_super_first[instr] ? concept_super_first[instr] : (instr))
+
+/**
+ * Seeded FNV-1a over a mnemonic, shared by the runtime and the table generator
+ *
+ * @param s const char*
+ * @param len size_t
+ * @param seed uint32_t
+ * @return uint32_t
+ */
+static inline uint32_t concept_opcode_hash(const char *s, size_t len, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char) s[i];
+        h *= 16777619u;
+    }
+    return h ^ (h >> 15);
+}
+
+/**
+ * Look up a mnemonic in O(1)
+ *
+ * @param mnemonic const char*, need not be terminated
+ * @param len size_t
+ * @return const ConceptOpcode_t*, NULL if unknown
+ */
+const ConceptOpcode_t *opcode_lookup(const char *mnemonic, size_t len);
+
+#endif
@@ -0,0 +1,593 @@
+// Copyright (c) Ruijie Fang. LICENSE included in the project repository.
+
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+
+#include "reg.h"
+
+/*
+ * Register tier
+ * -------------
+ * translate_procedures() lifts every verified procedure into three-address register code. A procedure's registers
+ * are its frame: first the argument and local slots, then one register per operand depth, so the operand at depth d
+ * lives in register slots + d (its "home") and calls pass arguments in place exactly like eval() does.
+ * The translator keeps a symbolic operand stack: constants and local loads are only remembered, and an instruction
+ * consuming them reads the constant or the local directly. Operands are written to their homes only before
+ * calls, jumps, labels and the opcodes without a register form, which run their stack handler on the frame.
+ * reg_eval() interprets the result; run() picks it with the --register flag.
+ */
+
+ConceptRegInstruction_t **reg_program;
+ConceptValue_t **reg_constants;
+int32_t *reg_program_length;
+int32_t **reg_labels;
+
+typedef struct {
+    ConceptArena_t *arena;
+    ConceptRegInstruction_t *code;
+    int32_t length, capacity;
+    ConceptValue_t *constants;
+    int32_t constant_count, constant_capacity;
+    int32_t *operands; // symbolic operand stack
+    int32_t depth;
+    int32_t slots;
+    int32_t barrier; // start of the current basic block, nothing before it may be rewritten
+} ConceptRegTranslation_t;
+
+#define REG_HOME(t, d) ((t)->slots + (d))
+
+static int32_t reg_emit(ConceptRegTranslation_t *t, int32_t op, int32_t dst, int32_t a, int32_t b, int32_t target) {
+    if (t->length == t->capacity) {
+        int32_t capacity = t->capacity ? t->capacity * 2 : 16;
+        t->code = arena_grow(t->arena, t->code, sizeof(ConceptRegInstruction_t) * t->capacity,
+                             sizeof(ConceptRegInstruction_t) * capacity);
+        t->capacity = capacity;
+    }
+    t->code[t->length] = (ConceptRegInstruction_t) {op, dst, a, b, target};
+    return t->length++;
+}
+
+static int32_t reg_constant(ConceptRegTranslation_t *t, ConceptValue_t value) {
+    if (t->constant_count == t->constant_capacity) {
+        int32_t capacity = t->constant_capacity ? t->constant_capacity * 2 : 8;
+        t->constants = arena_grow(t->arena, t->constants, sizeof(ConceptValue_t) * t->constant_capacity,
+                                  sizeof(ConceptValue_t) * capacity);
+        t->constant_capacity = capacity;
+    }
+    t->constants[t->constant_count] = value;
+    return ~(t->constant_count++);
+}
+
+// Write every pending operand to its home. An operand only ever refers to homes below its own, and a home
+// nobody has been written to is referred to by nobody, so the order of the moves does not matter.
+static void reg_flush(ConceptRegTranslation_t *t) {
+    for (int32_t d = 0; d < t->depth; d++) {
+        if (t->operands[d] != REG_HOME(t, d)) {
+            reg_emit(t, CONCEPT_REG_MOV, REG_HOME(t, d), t->operands[d], 0, 0);
+            t->operands[d] = REG_HOME(t, d);
+        }
+    }
+}
+
+// Before a local is overwritten, operands still reading it get their own copy
+static void reg_spill_local(ConceptRegTranslation_t *t, int32_t slot) {
+    for (int32_t d = 0; d < t->depth; d++) {
+        if (t->operands[d] == slot) {
+            reg_emit(t, CONCEPT_REG_MOV, REG_HOME(t, d), slot, 0, 0);
+            t->operands[d] = REG_HOME(t, d);
+        }
+    }
+}
+
+// Result of an instruction goes to the home of the depth it is pushed at
+static void reg_push_result(ConceptRegTranslation_t *t, int32_t op, int32_t a, int32_t b, int32_t target) {
+    int32_t home = REG_HOME(t, t->depth);
+    reg_emit(t, op, home, a, b, target);
+    t->operands[t->depth++] = home;
+}
+
+static void reg_reset_operands(ConceptRegTranslation_t *t, int32_t depth) {
+    t->depth = depth;
+    for (int32_t d = 0; d < depth; d++)
+        t->operands[d] = REG_HOME(t, d);
+}
+
+// Translate procedure p, allocating its register code from arena
+void translate_procedure(int32_t p, ConceptArena_t *arena) {
+    int32_t len = procedure_length_table[p];
+    ConceptInstruction_t *code = program[p];
+    ConceptRegTranslation_t t = {0};
+    t.arena = arena;
+    t.slots = FRAME_SLOTS(p);
+    t.operands = arena_alloc(&scratch_arena, sizeof(int32_t) * (procedure_max_depth_table[p] + 1));
+
+    int32_t *depths = arena_alloc(&scratch_arena, sizeof(int32_t) * (len + 1));
+    verify_procedure(p, depths);
+    int32_t *pcs = arena_alloc(&scratch_arena, sizeof(int32_t) * (len + 1)); // stack index -> register index
+    BOOL *labels = scratch_calloc((size_t) len + 1, sizeof(BOOL));
+    for (int32_t i = 0; i < len; i++)
+        if (PLAIN_OPCODE(code[i].instr) == CONCEPT_GOTO || PLAIN_OPCODE(code[i].instr) == CONCEPT_IF_ICMPLE)
+            labels[code[i].as.i] = 1;
+    // jumps off the end return whatever is on top, which depends on the depth at the jump
+    int32_t *exits = arena_alloc(&scratch_arena, sizeof(int32_t) * (procedure_max_depth_table[p] + 1));
+    for (int32_t d = 0; d <= procedure_max_depth_table[p]; d++)
+        exits[d] = -1;
+
+    BOOL reachable = 0;
+    for (int32_t i = 0; i < len; i++) {
+        if (depths[i] < 0) { // never reached, nothing can jump here either
+            pcs[i] = t.length;
+            reachable = 0;
+            continue;
+        }
+        if (labels[i]) { // the fall-through path brings its operands home, jumps already have
+            if (reachable)
+                reg_flush(&t);
+            t.barrier = t.length;
+        }
+        pcs[i] = t.length;
+        if (!reachable)
+            reg_reset_operands(&t, depths[i]);
+        reachable = 1;
+
+        int32_t instr = PLAIN_OPCODE(code[i].instr);
+        int32_t a, b;
+        switch (instr) {
+            case CONCEPT_ICONST:
+                t.operands[t.depth++] = reg_constant(&t, value_int(code[i].as.i));
+                break;
+            case CONCEPT_FCONST:
+                t.operands[t.depth++] = reg_constant(&t, value_float(code[i].as.f));
+                break;
+            case CONCEPT_CCONST:
+                t.operands[t.depth++] = reg_constant(&t, value_char(code[i].as.c));
+                break;
+            case CONCEPT_BCONST:
+                t.operands[t.depth++] = reg_constant(&t, value_bool(code[i].as.i));
+                break;
+            case CONCEPT_SCONST:
+                t.operands[t.depth++] = reg_constant(&t, value_string(string_pool + code[i].as.s));
+                break;
+            case CONCEPT_VCONST:
+                break;
+            case CONCEPT_LOAD:
+            case CONCEPT_FLOAD:
+                t.operands[t.depth++] = code[i].as.i;
+                break;
+            case CONCEPT_STORE:
+            case CONCEPT_FSTORE: {
+                int32_t slot = code[i].as.i;
+                a = t.operands[--t.depth];
+                reg_spill_local(&t, slot);
+                ConceptRegInstruction_t *last = t.length > t.barrier ? &t.code[t.length - 1] : NULL;
+                if (a == REG_HOME(&t, t.depth) && last != NULL && last->dst == a && last->op <= CONCEPT_REG_GLOAD)
+                    last->dst = slot; // the value was just computed, compute it into the local instead
+                else if (a != slot)
+                    reg_emit(&t, CONCEPT_REG_MOV, slot, a, 0, 0);
+                break;
+            }
+            case CONCEPT_IADD:
+            case CONCEPT_IMUL:
+            case CONCEPT_IDIV:
+            case CONCEPT_FADD:
+            case CONCEPT_FMUL:
+            case CONCEPT_FDIV:
+            case CONCEPT_ILT:
+            case CONCEPT_IEQ:
+            case CONCEPT_IGT: {
+                static const int32_t ops[] = {
+                        [CONCEPT_IADD - CONCEPT_IADD] = CONCEPT_REG_IADD,
+                        [CONCEPT_IDIV - CONCEPT_IADD] = CONCEPT_REG_IDIV,
+                        [CONCEPT_IMUL - CONCEPT_IADD] = CONCEPT_REG_IMUL,
+                        [CONCEPT_FADD - CONCEPT_IADD] = CONCEPT_REG_FADD,
+                        [CONCEPT_FDIV - CONCEPT_IADD] = CONCEPT_REG_FDIV,
+                        [CONCEPT_FMUL - CONCEPT_IADD] = CONCEPT_REG_FMUL,
+                        [CONCEPT_ILT - CONCEPT_IADD] = CONCEPT_REG_ILT,
+                        [CONCEPT_IEQ - CONCEPT_IADD] = CONCEPT_REG_IEQ,
+                        [CONCEPT_IGT - CONCEPT_IADD] = CONCEPT_REG_IGT,
+                };
+                a = t.operands[--t.depth];
+                b = t.operands[--t.depth];
+                // integer operations on two constants are done here, unless they would fail at runtime
+                if (a < 0 && b < 0 && instr != CONCEPT_FADD && instr != CONCEPT_FMUL && instr != CONCEPT_FDIV) {
+                    int64_t x = t.constants[~a].as.i, y = t.constants[~b].as.i, c;
+                    ConceptValue_t folded;
+                    if (instr == CONCEPT_ILT || instr == CONCEPT_IEQ || instr == CONCEPT_IGT) {
+                        folded = value_bool(instr == CONCEPT_ILT ? x < y : instr == CONCEPT_IEQ ? x == y : x > y);
+                    } else {
+                        c = instr == CONCEPT_IADD ? x + y : instr == CONCEPT_IMUL ? x * y : y != 0 ? x / y : INT64_MAX;
+                        if (c > INT32_MAX || c < INT32_MIN)
+                            goto unfolded;
+                        folded = value_int((int32_t) c);
+                    }
+                    t.operands[t.depth++] = reg_constant(&t, folded);
+                    break;
+                }
+                unfolded:
+                // a comparison feeding the next if_icmple becomes a compare-and-branch
+                if ((instr == CONCEPT_ILT || instr == CONCEPT_IEQ || instr == CONCEPT_IGT) && i + 1 < len
+                    && PLAIN_OPCODE(code[i + 1].instr) == CONCEPT_IF_ICMPLE && !labels[i + 1]) {
+                    reg_flush(&t);
+                    reg_emit(&t, CONCEPT_REG_JNLT + (ops[instr - CONCEPT_IADD] - CONCEPT_REG_ILT), t.depth, a, b,
+                             code[i + 1].as.i);
+                    pcs[++i] = t.length;
+                    break;
+                }
+                reg_push_result(&t, ops[instr - CONCEPT_IADD], a, b, 0);
+                break;
+            }
+            case CONCEPT_INC:
+            case CONCEPT_DEC:
+                a = t.operands[--t.depth];
+                reg_push_result(&t, instr == CONCEPT_INC ? CONCEPT_REG_INC : CONCEPT_REG_DEC, a, 0, 0);
+                break;
+            case CONCEPT_DUP:
+                a = t.operands[t.depth - 1];
+                t.operands[t.depth++] = a;
+                break;
+            case CONCEPT_POP:
+                t.depth--;
+                break;
+            case CONCEPT_SWAP: {
+                int32_t low = REG_HOME(&t, t.depth - 2), high = REG_HOME(&t, t.depth - 1);
+                a = t.operands[t.depth - 1];
+                b = t.operands[t.depth - 2];
+                if (a == low && b == low) // a dup'd operand
+                    break;
+                if (a == high && b == low) { // both in their homes, the handler swaps them
+                    reg_flush(&t);
+                    reg_emit(&t, CONCEPT_REG_STACK, t.depth, 0, 0, instr);
+                    break;
+                }
+                // an operand in one of the two homes moves to the other one, anything else just trades places
+                if (a == high)
+                    reg_emit(&t, CONCEPT_REG_MOV, low, a, 0, 0), a = low;
+                if (b == low)
+                    reg_emit(&t, CONCEPT_REG_MOV, high, b, 0, 0), b = high;
+                t.operands[t.depth - 1] = b;
+                t.operands[t.depth - 2] = a;
+                break;
+            }
+            case CONCEPT_GLOAD:
+                reg_push_result(&t, CONCEPT_REG_GLOAD, 0, 0, code[i].as.i);
+                break;
+            case CONCEPT_GSTORE:
+                a = t.operands[--t.depth];
+                reg_emit(&t, CONCEPT_REG_GSTORE, 0, a, 0, code[i].as.i);
+                break;
+            case CONCEPT_PRINT:
+                if (t.depth > 0)
+                    reg_emit(&t, CONCEPT_REG_PRINT, 0, t.operands[t.depth - 1], 0, 0);
+                break;
+            case CONCEPT_CALL: {
+                int32_t callee = code[i].as.i;
+                reg_flush(&t);
+                t.depth -= procedure_args_table[callee];
+                reg_emit(&t, CONCEPT_REG_CALL, REG_HOME(&t, t.depth), 0, 0, callee);
+                t.operands[t.depth] = REG_HOME(&t, t.depth);
+                t.depth++;
+                break;
+            }
+            case CONCEPT_IF_ICMPLE:
+                a = t.operands[--t.depth];
+                if (a < 0 && t.constants[~a].as.i) // a folded condition that holds never jumps
+                    break;
+                reg_flush(&t);
+                if (a < 0) { // nor does one that fails ever fall through
+                    reg_emit(&t, CONCEPT_REG_JMP, t.depth, 0, 0, code[i].as.i);
+                    reachable = 0;
+                    break;
+                }
+                reg_emit(&t, CONCEPT_REG_JF, t.depth, a, 0, code[i].as.i);
+                break;
+            case CONCEPT_GOTO:
+                reg_flush(&t);
+                reg_emit(&t, CONCEPT_REG_JMP, t.depth, 0, 0, code[i].as.i);
+                reachable = 0;
+                break;
+            case CONCEPT_TAILCALL:
+                reg_flush(&t);
+                t.depth -= procedure_args_table[code[i].as.i];
+                reg_emit(&t, CONCEPT_REG_TAILCALL, REG_HOME(&t, t.depth), 0, 0, code[i].as.i);
+                reachable = 0;
+                break;
+            case CONCEPT_RETURN:
+                if (t.depth > 0)
+                    reg_emit(&t, CONCEPT_REG_RET, 0, t.operands[t.depth - 1], 0, 0);
+                else
+                    reg_emit(&t, CONCEPT_REG_RETV, 0, 0, 0, 0);
+                reachable = 0;
+                break;
+            case CONCEPT_HALT:
+                reg_emit(&t, CONCEPT_REG_HALT, 0, 0, 0, 0);
+                reachable = 0;
+                break;
+            default: // no register form: run the stack handler on the homes
+                reg_flush(&t);
+                reg_emit(&t, CONCEPT_REG_STACK, t.depth, 0, 0, instr);
+                reg_reset_operands(&t, t.depth - concept_opcodes[instr].pops + concept_opcodes[instr].pushes);
+                break;
+        }
+    }
+    pcs[len] = -1;
+    if (reachable || len == 0) { // falls off the end
+        if (t.depth > 0)
+            reg_emit(&t, CONCEPT_REG_RET, 0, t.operands[t.depth - 1], 0, 0);
+        else
+            reg_emit(&t, CONCEPT_REG_RETV, 0, 0, 0, 0);
+    }
+
+    // resolve jumps; jumps carry their depth in dst, and as the operands are in their homes at every jump,
+    // a jump off the end goes to a return of the top home at that depth
+    int32_t count = t.length;
+    for (int32_t r = 0; r < count; r++) {
+        if (t.code[r].op < CONCEPT_REG_JMP || t.code[r].op > CONCEPT_REG_JNGT)
+            continue;
+        if (t.code[r].target < len) {
+            t.code[r].target = pcs[t.code[r].target];
+            continue;
+        }
+        int32_t depth = t.code[r].dst;
+        if (exits[depth] < 0)
+            exits[depth] = depth > 0 ? reg_emit(&t, CONCEPT_REG_RET, 0, REG_HOME(&t, depth - 1), 0, 0)
+                                     : reg_emit(&t, CONCEPT_REG_RETV, 0, 0, 0, 0);
+        t.code[r].target = exits[depth];
+    }
+
+    int32_t *entries = arena_alloc(arena, sizeof(int32_t) * (len + 1));
+    for (int32_t i = 0; i <= len; i++)
+        entries[i] = i < len && labels[i] && depths[i] >= 0 ? pcs[i] : -1;
+    reg_labels[p] = entries;
+    reg_program[p] = t.code;
+    reg_constants[p] = t.constants;
+    reg_program_length[p] = t.length;
+#ifdef DEBUG
+    printf("\nRegister: procedure %s, %d stack instructions -> %d register instructions, %d constants\n",
+           procedure_call_table[p], len, t.length, t.constant_count);
+#endif
+}
+
+// Tables for the register code of every procedure, filled in by translate_procedure()
+void reg_alloc_tables() {
+    size_t n = (size_t) procedure_length_table_length;
+    reg_program = arena_alloc(&program_arena, sizeof(ConceptRegInstruction_t *) * n);
+    reg_constants = arena_alloc(&program_arena, sizeof(ConceptValue_t *) * n);
+    reg_program_length = arena_alloc(&program_arena, sizeof(int32_t) * n);
+    reg_labels = arena_alloc(&program_arena, sizeof(int32_t *) * n);
+    memset(reg_program, 0, sizeof(ConceptRegInstruction_t *) * n); // not translated yet
+}
+
+// Lift every verified procedure into register code
+void translate_procedures() {
+    reg_alloc_tables();
+    for (int32_t p = 0; p < procedure_length_table_length; p++)
+        translate_procedure(p, &program_arena);
+}
+
+#define REG_OPERAND(x) ((x) >= 0 ? regs[x] : constants[~(x)])
+
+// Enter a procedure whose frame starts at base: the arguments are already in place, every other register starts
+// out void so that the collector never sees a stale slot. The stack view is the frame's operand part, which is
+// where the stack handlers and the collector look.
+#define REG_PROCEDURE_ENTER(p) \
+    do { \
+        index = (p); \
+        int32_t slots = FRAME_SLOTS(index); \
+        int32_t registers = slots + procedure_max_depth_table[index]; \
+        if (base + registers > stack_size) \
+            on_error(CONCEPT_STACK_OVERFLOW, "Stack is full, operation abort.", CONCEPT_STATE_ERROR, \
+                     CONCEPT_WARN_EXITNOW); \
+        regs = stack_bottom + base; \
+        for (int32_t r = procedure_args_table[index]; r < registers; r++) \
+            regs[r] = value_void(NULL); \
+        stack->operand_stack = regs + slots; \
+        stack->size = stack_size - base - slots; \
+        stack->top = -1; \
+        code = reg_program[index]; \
+        constants = reg_constants[index]; \
+        pc = 0; \
+        STATS_CALL(concept_stats, index); \
+    } while (0)
+
+// Leave with a value: it replaces the first argument register, which is the caller's result register
+#define REG_PROCEDURE_RETURN(value) \
+    do { \
+        ConceptValue_t ret = (value); \
+        if (frames->top <= frames_floor) { \
+            stack->operand_stack = stack_bottom; \
+            stack->size = stack_size; \
+            stack->top = base - 1; \
+            return ret; \
+        } \
+        ConceptFrame_t *frame = &frames->frames[(frames->top)--]; \
+        stack_bottom[base] = ret; \
+        base = frame->stack_base; \
+        index = frame->procedure; \
+        regs = stack_bottom + base; \
+        stack->operand_stack = regs + FRAME_SLOTS(index); \
+        stack->size = stack_size - base - FRAME_SLOTS(index); \
+        code = reg_program[index]; \
+        constants = reg_constants[index]; \
+        pc = frame->return_pc + 1; \
+    } while (0)
+
+// Register code interpreter, the counterpart of eval(): same frames, same stack, same results.
+// The stack view has to be the whole stack, its operands being the arguments of procedure index. Procedures the
+// JIT compiled are called natively; natives call back in here for procedures it left to the interpreter.
+ConceptValue_t reg_eval(int32_t index, ConceptStack_t *stack, ConceptValue_t *globals, ConceptFrameStack_t *frames) {
+    ConceptValue_t *stack_bottom = stack->operand_stack;
+    int32_t stack_size = stack->size;
+    int32_t base = stack->top + 1 - procedure_args_table[index];
+    int32_t frames_floor = frames->top; // returning below the frames found on entry leaves reg_eval()
+    ConceptValue_t *regs;
+    const ConceptValue_t *constants;
+    const ConceptRegInstruction_t *code;
+    int32_t pc;
+    BOOL profiled = profiling;
+
+    if (jit_program != NULL && jit_program[index] != NULL) {
+        PROFILE_PUBLISH(CONCEPT_PROFILE_JIT, -1);
+        jit_program[index](stack_bottom + base);
+        stack->top = base - 1;
+        return stack_bottom[base];
+    }
+    REG_PROCEDURE_ENTER(index);
+    for (;;) {
+        const ConceptRegInstruction_t *in = &code[pc++];
+        PROFILE_PUBLISH(index, -1); // register code has no stack pc
+#ifdef DEBUG
+        printf("\n reg_eval: Dispatching register instruction %d @ index %d: %d", pc - 1, index, in->op);
+#endif
+        switch (in->op) {
+            case CONCEPT_REG_MOV:
+                regs[in->dst] = REG_OPERAND(in->a);
+                break;
+            case CONCEPT_REG_IADD: {
+                int64_t c = (int64_t) REG_OPERAND(in->a).as.i + REG_OPERAND(in->b).as.i;
+                if (c > INT32_MAX || c < INT32_MIN)
+                    on_error(CONCEPT_BUFFER_OVERFLOW, "IADD Operation exceeds INT_MAX limit, Aborting...",
+                             CONCEPT_STATE_ERROR, CONCEPT_ABORT);
+                regs[in->dst] = value_int((int32_t) c);
+                break;
+            }
+            case CONCEPT_REG_IMUL: {
+                int64_t c = (int64_t) REG_OPERAND(in->a).as.i * REG_OPERAND(in->b).as.i;
+                if (c > INT32_MAX || c < INT32_MIN)
+                    on_error(CONCEPT_BUFFER_OVERFLOW, "IMUL Operation exceeds INT_MAX limit, Aborting...",
+                             CONCEPT_STATE_ERROR, CONCEPT_ABORT);
+                regs[in->dst] = value_int((int32_t) c);
+                break;
+            }
+            case CONCEPT_REG_IDIV: {
+                int32_t a = REG_OPERAND(in->a).as.i;
+                int32_t b = REG_OPERAND(in->b).as.i;
+                if (b == 0 || (a == INT32_MIN && b == -1))
+                    on_error(CONCEPT_BUFFER_OVERFLOW,
+                             "IDIV Operation divides by zero or exceeds INT_MAX limit, Aborting...",
+                             CONCEPT_STATE_ERROR, CONCEPT_ABORT);
+                regs[in->dst] = value_int(a / b);
+                break;
+            }
+            case CONCEPT_REG_FADD: {
+                float c = REG_OPERAND(in->a).as.f + REG_OPERAND(in->b).as.f;
+                if (!(c <= FLT_MAX && c >= -FLT_MAX))
+                    on_error(CONCEPT_BUFFER_OVERFLOW, "FADD Operation exceeds FLT_MAX limit, Aborting...",
+                             CONCEPT_STATE_ERROR, CONCEPT_ABORT);
+                regs[in->dst] = value_float(c);
+                break;
+            }
+            case CONCEPT_REG_FMUL: {
+                float c = REG_OPERAND(in->a).as.f * REG_OPERAND(in->b).as.f;
+                if (!(c <= FLT_MAX && c >= -FLT_MAX))
+                    on_error(CONCEPT_BUFFER_OVERFLOW, "FMUL Operation exceeds FLT_MAX limit, Aborting...",
+                             CONCEPT_STATE_ERROR, CONCEPT_ABORT);
+                regs[in->dst] = value_float(c);
+                break;
+            }
+            case CONCEPT_REG_FDIV: {
+                float c = REG_OPERAND(in->a).as.f / REG_OPERAND(in->b).as.f;
+                if (!(c <= FLT_MAX && c >= -FLT_MAX))
+                    on_error(CONCEPT_BUFFER_OVERFLOW, "FDIV Operation exceeds FLT_MAX limit, Aborting...",
+                             CONCEPT_STATE_ERROR, CONCEPT_ABORT);
+                regs[in->dst] = value_float(c);
+                break;
+            }
+            case CONCEPT_REG_ILT:
+                regs[in->dst] = value_bool(REG_OPERAND(in->a).as.i < REG_OPERAND(in->b).as.i);
+                break;
+            case CONCEPT_REG_IEQ:
+                regs[in->dst] = value_bool(REG_OPERAND(in->a).as.i == REG_OPERAND(in->b).as.i);
+                break;
+            case CONCEPT_REG_IGT:
+                regs[in->dst] = value_bool(REG_OPERAND(in->a).as.i > REG_OPERAND(in->b).as.i);
+                break;
+            case CONCEPT_REG_INC:
+                regs[in->dst] = REG_OPERAND(in->a);
+                regs[in->dst].as.i++;
+                break;
+            case CONCEPT_REG_DEC:
+                regs[in->dst] = REG_OPERAND(in->a);
+                regs[in->dst].as.i--;
+                break;
+            case CONCEPT_REG_GLOAD:
+                regs[in->dst] = globals[in->target];
+                break;
+            case CONCEPT_REG_GSTORE:
+                globals[in->target] = REG_OPERAND(in->a);
+                break;
+            case CONCEPT_REG_JMP:
+                pc = in->target;
+                break;
+            case CONCEPT_REG_JF:
+                if (!REG_OPERAND(in->a).as.i)
+                    pc = in->target;
+                break;
+            case CONCEPT_REG_JNLT:
+                if (!(REG_OPERAND(in->a).as.i < REG_OPERAND(in->b).as.i))
+                    pc = in->target;
+                break;
+            case CONCEPT_REG_JNEQ:
+                if (!(REG_OPERAND(in->a).as.i == REG_OPERAND(in->b).as.i))
+                    pc = in->target;
+                break;
+            case CONCEPT_REG_JNGT:
+                if (!(REG_OPERAND(in->a).as.i > REG_OPERAND(in->b).as.i))
+                    pc = in->target;
+                break;
+            case CONCEPT_REG_CALL: {
+                if (frames->top >= frames->size - 1)
+                    on_error(CONCEPT_STACK_OVERFLOW, "Call stack is full, operation abort.", CONCEPT_STATE_ERROR,
+                             CONCEPT_WARN_EXITNOW);
+                if (jit_program != NULL && jit_program[in->target] != NULL) {
+                    frames->frames[++(frames->top)].procedure = index; // the caller, for the profiler
+                    PROFILE_PUBLISH(CONCEPT_PROFILE_JIT, -1);
+                    jit_program[in->target](regs + in->dst);
+                    frames->top--;
+                    break;
+                }
+                ConceptFrame_t *frame = &frames->frames[++(frames->top)];
+                frame->return_pc = pc - 1;
+                frame->procedure = index;
+                frame->stack_base = base;
+                base += in->dst;
+                REG_PROCEDURE_ENTER(in->target);
+                break;
+            }
+            case CONCEPT_REG_TAILCALL: // the callee takes over this frame
+                memmove(regs, regs + in->dst, sizeof(ConceptValue_t) * procedure_args_table[in->target]);
+                if (jit_program != NULL && jit_program[in->target] != NULL) {
+                    PROFILE_PUBLISH(CONCEPT_PROFILE_JIT, -1);
+                    jit_program[in->target](regs);
+                    REG_PROCEDURE_RETURN(regs[0]);
+                    break;
+                }
+                REG_PROCEDURE_ENTER(in->target);
+                break;
+            case CONCEPT_REG_RET:
+                REG_PROCEDURE_RETURN(REG_OPERAND(in->a));
+                break;
+            case CONCEPT_REG_RETV:
+                on_error(CONCEPT_GENERAL_ERROR, "Stack is empty. Returning a void value.", CONCEPT_STATE_INFO,
+                         CONCEPT_WARN_NOEXIT);
+                REG_PROCEDURE_RETURN(value_void(NULL));
+                break;
+            case CONCEPT_REG_PRINT: {
+                ConceptValue_t v = REG_OPERAND(in->a);
+                print_value(&v);
+                break;
+            }
+            case CONCEPT_REG_STACK: // natives move the view, so it is set here rather than trusted
+                stack->operand_stack = regs + FRAME_SLOTS(index);
+                stack->top = in->dst - 1;
+                concept_opcodes[in->target].handler(stack);
+                break;
+            case CONCEPT_REG_HALT:
+                on_error(CONCEPT_GENERAL_ERROR, " Exit by HALT.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+                break;
+            default:
+                on_error(CONCEPT_COMPILER_ERROR, "Error: Unknown register instruction", CONCEPT_STATE_CATASTROPHE,
+                         CONCEPT_ABORT);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * reg.h
+ *
+ * Register tier: three-address code lifted from the verified stack code, and its interpreter
+ * Copyright (c) 2016 Ruijie Fang <ruijief@acm.org>
+ */
+
+#ifndef REG_H_
+#define REG_H_
+
+#include "vm.h"
+
+#define CONCEPT_REG_MOV 0 // dst = a
+#define CONCEPT_REG_IADD 1 // dst = a + b, operands as popped by the stack form: a was on top
+#define CONCEPT_REG_IMUL 2
+#define CONCEPT_REG_IDIV 3
+#define CONCEPT_REG_FADD 4
+#define CONCEPT_REG_FMUL 5
+#define CONCEPT_REG_FDIV 6
+#define CONCEPT_REG_ILT 7
+#define CONCEPT_REG_IEQ 8
+#define CONCEPT_REG_IGT 9
+#define CONCEPT_REG_INC 10 // dst = a, then incremented in place
+#define CONCEPT_REG_DEC 11
+#define CONCEPT_REG_GLOAD 12 // dst = globals[target]
+#define CONCEPT_REG_GSTORE 13 // globals[target] = a
+#define CONCEPT_REG_JMP 14
+#define CONCEPT_REG_JF 15 // jump when a is false
+#define CONCEPT_REG_JNLT 16 // jump unless a < b, i.e. ilt + if_icmple
+#define CONCEPT_REG_JNEQ 17
+#define CONCEPT_REG_JNGT 18
+#define CONCEPT_REG_CALL 19 // callee target, arguments from register dst on, result in dst
+#define CONCEPT_REG_RET 20 // return a
+#define CONCEPT_REG_RETV 21 // return from an empty stack
+#define CONCEPT_REG_PRINT 22
+#define CONCEPT_REG_STACK 23 // stack handler of opcode target, on operands in their homes up to depth dst
+#define CONCEPT_REG_HALT 24
+#define CONCEPT_REG_TAILCALL 25 // callee target takes over the frame, arguments from register dst on
+
+// Register operand: a register index, or ~k for constant k of the procedure
+typedef struct {
+    int32_t op;
+    int32_t dst;
+    int32_t a;
+    int32_t b;
+    int32_t target; // register code index, callee, global or opcode
+} ConceptRegInstruction_t;
+
+// Register code and constants of every procedure, NULL where a procedure is not translated (yet)
+extern ConceptRegInstruction_t **reg_program;
+extern ConceptValue_t **reg_constants;
+extern int32_t *reg_program_length;
+// Per procedure, indexed by stack instruction: where a jump target starts in the register code, -1 elsewhere.
+// All operands are in their homes there, just like in eval()'s frame.
+extern int32_t **reg_labels;
+
+/**
+ * Translate procedure p, allocating its register code from arena. The tables have to be allocated.
+ *
+ * @param p int32_t
+ * @param arena ConceptArena_t*
+ * @return void
+ */
+void translate_procedure(int32_t p, ConceptArena_t *arena);
+/**
+ * Allocate the register code tables of the loaded program, every procedure untranslated.
+ *
+ * @return void
+ */
+void reg_alloc_tables();
+/**
+ * Lift every verified procedure into register code.
+ *
+ * @return void
+ */
+void translate_procedures();
+/**
+ * Run procedure index on the register code of translate_procedures(), natively where the JIT compiled it.
+ *
+ * @param index int32_t
+ * @param stack ConceptStack_t*
+ * @param globals ConceptValue_t*
+ * @param frames ConceptFrameStack_t*
+ * @return ConceptValue_t
+ */
+ConceptValue_t reg_eval(int32_t index, ConceptStack_t *stack, ConceptValue_t *globals, ConceptFrameStack_t *frames);
+#endif
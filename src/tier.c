@@ -0,0 +1,137 @@
+// Copyright (c) Ruijie Fang. LICENSE included in the project repository.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <signal.h>
+
+#include "tier.h"
+#include "reg.h"
+#include "jit.h"
+
+/*
+ * Tiered execution
+ * ----------------
+ * With --tiered, eval() runs everything and counts invocations and backward jumps per procedure. A procedure
+ * whose count reaches tier_threshold is queued for a background thread, which translates it to register code
+ * (folding constants on the way), compiles it alone into its own mapping and publishes it in jit_program, plus
+ * entries at its loop headers in jit_osr. eval() calls the native code at the next invocation, and a running
+ * invocation switches over at its next backward jump; the register frame is eval()'s frame there. Procedures that
+ * never get hot are never translated.
+ */
+
+#ifdef CONCEPT_JIT
+
+// The tiering compiler: a worker thread taking procedures off a queue, each requested at most once
+static pthread_t tier_thread;
+static pthread_mutex_t tier_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tier_wake = PTHREAD_COND_INITIALIZER;
+static int32_t *tier_queue;
+static int32_t tier_queue_head, tier_queue_tail;
+static BOOL *tier_requested;
+static BOOL tier_stopping;
+static BOOL tier_running = 0;
+// register code compiled in the background, not to be shared with the main thread's program_arena
+static ConceptArena_t tier_arena = {NULL, NULL};
+
+// Hand procedure p to the tiering compiler, unless it was already
+void tier_request(int32_t p) {
+    pthread_mutex_lock(&tier_lock);
+    if (!tier_requested[p]) {
+        tier_requested[p] = 1;
+        tier_queue[tier_queue_tail++] = p;
+        pthread_cond_signal(&tier_wake);
+    }
+    pthread_mutex_unlock(&tier_lock);
+}
+
+// Translate and compile procedure p, then publish its code: the entries are complete before they are visible
+static void tier_compile(int32_t p) {
+    translate_procedure(p, &tier_arena);
+    if (jit_compile_procedure(p, &tier_arena)) {
+#ifdef DEBUG
+        printf("\nTier: procedure %s compiled after %u calls and %u backward jumps\n", procedure_call_table[p],
+               procedure_call_counts[p], procedure_backedge_counts[p]);
+#endif
+    }
+    arena_free(&scratch_arena);
+}
+
+static void *tier_worker(void *unused) {
+    (void) unused;
+    // the profiler samples the interpreter thread only
+    sigset_t blocked;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGPROF);
+    pthread_sigmask(SIG_BLOCK, &blocked, NULL);
+    pthread_mutex_lock(&tier_lock);
+    for (;;) {
+        while (tier_queue_head == tier_queue_tail && !tier_stopping)
+            pthread_cond_wait(&tier_wake, &tier_lock);
+        if (tier_stopping) // whatever is still queued is not needed any more
+            break;
+        int32_t p = tier_queue[tier_queue_head++];
+        pthread_mutex_unlock(&tier_lock);
+        tier_compile(p);
+        pthread_mutex_lock(&tier_lock);
+    }
+    pthread_mutex_unlock(&tier_lock);
+    return NULL;
+}
+
+// Start counting and compiling for a run on the given stack and frames
+void tier_start(ConceptStack_t *stack, ConceptFrameStack_t *frames, uint32_t threshold) {
+    size_t n = (size_t) procedure_length_table_length;
+    jit_attach(stack, frames);
+    reg_alloc_tables();
+    jit_program = arena_alloc(&program_arena, sizeof(ConceptJitProcedure_t) * n);
+    jit_osr = arena_alloc(&program_arena, sizeof(ConceptJitProcedure_t *) * n);
+    for (size_t p = 0; p < n; p++) {
+        atomic_init(&jit_program[p], NULL);
+        atomic_init(&jit_osr[p], NULL);
+    }
+    tier_queue = arena_alloc(&program_arena, sizeof(int32_t) * n);
+    tier_requested = arena_alloc(&program_arena, sizeof(BOOL) * n);
+    memset(tier_requested, 0, sizeof(BOOL) * n);
+    tier_queue_head = tier_queue_tail = 0;
+    tier_stopping = 0;
+    if (pthread_create(&tier_thread, NULL, tier_worker, NULL) != 0) {
+        on_error(CONCEPT_GENERAL_ERROR, "Cannot start the tiering compiler, interpreting instead.",
+                 CONCEPT_STATE_WARNING, CONCEPT_WARN_NOEXIT);
+        return;
+    }
+    tier_running = 1;
+    tier_threshold = threshold;
+}
+
+// Stop the tiering compiler; compiled code stays until jit_release()
+void tier_stop() {
+    if (!tier_running)
+        return;
+    pthread_mutex_lock(&tier_lock);
+    tier_stopping = 1;
+    pthread_cond_signal(&tier_wake);
+    pthread_mutex_unlock(&tier_lock);
+    pthread_join(tier_thread, NULL);
+    tier_running = 0;
+    tier_threshold = 0;
+    arena_free(&tier_arena);
+}
+#else
+void tier_request(int32_t p) {
+    (void) p;
+}
+
+void tier_start(ConceptStack_t *stack, ConceptFrameStack_t *frames, uint32_t threshold) {
+    (void) stack;
+    (void) frames;
+    (void) threshold;
+    on_error(CONCEPT_GENERAL_ERROR, "No JIT on this platform, interpreting instead.", CONCEPT_STATE_WARNING,
+             CONCEPT_WARN_NOEXIT);
+}
+
+void tier_stop() {
+}
+#endif
@@ -0,0 +1,35 @@
+/*
+ * tier.h
+ *
+ * Tiered execution: eval() counts, hot procedures are translated and compiled on a background thread
+ * Copyright (c) 2016 Ruijie Fang <ruijief@acm.org>
+ */
+
+#ifndef TIER_H_
+#define TIER_H_
+
+#include "vm.h"
+
+/**
+ * Hand procedure p to the tiering compiler, unless it was already.
+ *
+ * @param p int32_t
+ * @return void
+ */
+void tier_request(int32_t p);
+/**
+ * Start counting and compiling hot procedures in the background for a run on the given stack and frames.
+ *
+ * @param stack ConceptStack_t*
+ * @param frames ConceptFrameStack_t*
+ * @param threshold uint32_t calls plus backward jumps
+ * @return void
+ */
+void tier_start(ConceptStack_t *stack, ConceptFrameStack_t *frames, uint32_t threshold);
+/**
+ * Stop the tiering compiler; compiled code stays until jit_release().
+ *
+ * @return void
+ */
+void tier_stop();
+#endif
@@ -0,0 +1,3291 @@
+/*
+ * vm.c
+ * The "Conceptum" Turing-Complete VM source code file
+ * Copyright (c) 2016 Ruijie Fang <ruijief@acm.org>
+ * All versions released under The GNU General Public License v3.0.
+ * A LICENSE Copy can be found in the project repository.
+ * ALL RIGHTS RESERVED.
+ *
+ * ACKNOWLEDGEMENTS
+ * ----------------
+ *
+ *  - Jonathan Schug, who helped debug a memory error
+ *  - Tyler Liu, author of Inertia
+ *  - Creators of CLion for them not to do data flow analysis in CLion for mEsSy CoDE
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <limits.h>
+#include <float.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <setjmp.h>
+
+// Values, stacks, the program tables and the settings, see vm.h
+#include "vm.h"
+#include "reg.h"
+#include "jit.h"
+#include "tier.h"
+#include "opcode_hash.h"
+
+/* ========================
+ * Error handling functions
+ * ========================
+ */
+
+_Thread_local jmp_buf *concept_error_jump = NULL;
+
+_Noreturn void concept_exit(int32_t status) {
+    if (concept_error_jump != NULL)
+        longjmp(*concept_error_jump, status != 0 ? status : 1);
+    exit(status);
+}
+
+static int32_t if_handles_exception(int32_t if_exception) {
+    switch (if_exception) {
+        case CONCEPT_WARN_NOEXIT:
+            return 1;
+        case CONCEPT_NOWARNING_EXIT:
+            return 0;
+        case CONCEPT_WARN_EXITNOW:
+            return 0;
+        case CONCEPT_HALT:
+            return 0;
+        case CONCEPT_ABORT:
+            return 0;
+        default:
+            return 0;
+    }
+}
+
+void on_error(int32_t error, char *msg, int32_t action, int32_t if_exception) {  // TODO TODO Add Memory free!!
+    switch (action) {
+        case CONCEPT_STATE_INFO:
+            if (if_handles_exception(if_exception))
+                printf("[CONCEPTUM-Runtime] INFO: %s {%d}", msg, error);
+            break;
+        case CONCEPT_STATE_WARNING:
+            if (if_handles_exception(if_exception))
+                printf("[CONCEPTUM-Runtime] WARNING: %s {%d}", msg, error);
+            break;
+        case CONCEPT_STATE_ERROR:
+            if (if_handles_exception(if_exception))
+                printf("[CONCEPTUM-Runtime] NONEXIT ERROR: %s {%d}", msg, error);
+            else
+                printf("[CONCEPTUM-Runtime] EXIT ERROR: %s {%d}", msg, error);
+            concept_exit(if_exception);
+            break;
+        case CONCEPT_STATE_CATASTROPHE:
+            printf("[CONCEPTUM-Runtime]");
+            concept_exit(if_exception);
+    }
+}
+
+// Source text of the program, mapped read-only
+struct {
+    char *code;
+    size_t len;
+} concept_program;
+
+// A line or token inside the mapped source, NOT terminated
+typedef struct {
+    const char *start;
+    int32_t len;
+} ConceptView_t;
+
+// The loaded program, see vm.h
+char **procedure_call_table;
+int32_t procedure_call_table_length;
+int32_t *procedure_length_table;
+int32_t procedure_length_table_length;
+int32_t *procedure_args_table;
+int32_t *procedure_locals_table;
+int32_t *procedure_max_depth_table;
+ConceptValue_t *global_table;
+int32_t global_table_length;
+ConceptInstruction_t **program;
+char *string_pool;
+uint32_t string_pool_size;
+uint32_t *procedure_call_counts;
+uint32_t *procedure_backedge_counts;
+uint32_t tier_threshold = 0;
+_Atomic(ConceptJitProcedure_t) *jit_program = NULL;
+_Atomic(ConceptJitProcedure_t *) *jit_osr = NULL;
+
+
+/*
+ * Utility Functions (Might not be used at all)
+ * but for nominative references
+ */
+
+
+char *remove_spaces(char *src) {
+    char *dst = arena_alloc(&program_arena, strlen(src) + 1);
+    int32_t s, d = 0;
+    for (s = 0; src[s] != 0; s++)
+        if (src[s] != ' ' && src[s] != '\t') {
+            dst[d] = src[s];
+            d++;
+        }
+    dst[d] = 0;
+    return dst;
+}
+
+int is_void(char *s) {
+    while (*s != '\0') {
+        if (!isspace(*s))
+            return 0;
+        s++;
+    }
+    return 1;
+}
+
+int is_int(char *tbd) {
+    char *rmvd_tbd = remove_spaces(tbd);
+    return isdigit(atoi(rmvd_tbd));
+}
+
+int is_char(char *tbd) {
+    char *rmvd_tbd = remove_spaces(tbd);
+    return (strlen(rmvd_tbd) == 1) | (strlen(rmvd_tbd) == 0);
+}
+
+int is_float(char *tbd) {
+    double d = FLT_MAX;
+    d = strtod(tbd, NULL);
+    return ((d > 0 && (d > FLT_MAX || d < FLT_MIN))
+            || (d < 0 && (d < -FLT_MAX || d > -FLT_MIN)));
+}
+
+/*
+ * Stack Operations Functions
+ */
+
+// Allocate stack
+void stack_alloc(ConceptStack_t *stack, int32_t bt_size) {
+    // size of a value slot * maximum size
+    ConceptValue_t *stackContents = arena_alloc(&run_arena, sizeof(ConceptValue_t) * bt_size);
+    stack->operand_stack = stackContents;
+    stack->size = bt_size;
+    stack->top = (-1);
+
+#ifdef DEBUG
+    printf("\nSTACK: ALLOC ConceptStack_t @ addr %p , operand_stack @ addr %p, size %d\n", stack, stack->operand_stack,
+           stack->size);
+#endif
+
+}
+
+// Deallocate (reset) stack
+static void stack_dealloc(ConceptStack_t *stack) {
+    // values live inline in the stack array, which goes away with the run region
+    // reset stack properties
+    stack->operand_stack = NULL;
+    stack->top = -1;
+    stack->size = 0;
+}
+
+// Free stack memory
+void stack_free(ConceptStack_t *stack) {
+
+#ifdef DEBUG
+    printf("\tstack_free(): deallocating contents of stack...\n");
+#endif
+    // Deallocate the stack's contents and properties
+    stack_dealloc(stack);
+#ifdef DEBUG
+    printf("\tstack_free(): Fine. Return.\n\n");
+#endif
+}
+
+// Allocate the frame stack once, calls only ever write into it
+void frame_stack_alloc(ConceptFrameStack_t *frames, int32_t depth) {
+    frames->frames = arena_alloc(&run_arena, sizeof(ConceptFrame_t) * depth);
+    frames->size = depth;
+    frames->top = (-1);
+}
+
+void frame_stack_free(ConceptFrameStack_t *frames) {
+    frames->frames = NULL;
+    frames->top = -1;
+    frames->size = 0;
+}
+
+// IADD Integer addition function
+void concept_iadd(ConceptStack_t *stack) {
+    int32_t a = stack_pop_fast(stack).as.i;
+    int32_t b = stack_pop_fast(stack).as.i; // pop again for another value
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nIADD\n");
+    printf("\t%d\tPLUS\t", a);
+    printf("%d", b);
+#endif
+
+    int64_t c = (int64_t) a + b;
+
+    if (c <= INT32_MAX && c >= INT32_MIN) {
+        stack_push_fast(stack, value_int((int32_t) c));
+
+#ifdef DEBUG
+        printf("\nIADD finished, RESULT %d", (int32_t) c);
+#endif
+
+    } else {
+        // Exceeds maximum limit, quit
+        on_error(CONCEPT_BUFFER_OVERFLOW, "IADD Operation exceeds INT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                 CONCEPT_ABORT);
+    }
+}
+
+// IDIV Integer division function
+void concept_idiv(ConceptStack_t *stack) {
+    int32_t a = stack_pop_fast(stack).as.i;
+    int32_t b = stack_pop_fast(stack).as.i; // pop again for another value
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nIDIV\n");
+    printf("\t%d\tDIVBY\t", a);
+    printf("%d", b);
+#endif
+
+    if (b != 0 && !(a == INT32_MIN && b == -1)) {
+        stack_push_fast(stack, value_int(a / b));
+
+#ifdef DEBUG
+        printf("\nIDIV finished, RESULT %d", a / b);
+#endif
+
+    } else {
+        // Division by zero or exceeds maximum limit, quit
+        on_error(CONCEPT_BUFFER_OVERFLOW, "IDIV Operation divides by zero or exceeds INT_MAX limit, Aborting...",
+                 CONCEPT_STATE_ERROR, CONCEPT_ABORT);
+    }
+}
+
+// IMUL Integer Multiplication function
+void concept_imul(ConceptStack_t *stack) {
+    int32_t a = stack_pop_fast(stack).as.i;
+    int32_t b = stack_pop_fast(stack).as.i; // pop again for another value
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nIMUL\n");
+    printf("\t%d\tTIMES\t", a);
+    printf("%d", b);
+#endif
+
+    int64_t c = (int64_t) a * b;
+
+    if (c <= INT32_MAX && c >= INT32_MIN) {
+        stack_push_fast(stack, value_int((int32_t) c));
+
+#ifdef DEBUG
+        printf("\nIMUL finished, RESULT %d", (int32_t) c);
+#endif
+    } else {
+        // Exceeds maximum limit, quit
+        on_error(CONCEPT_BUFFER_OVERFLOW, "IMUL Operation exceeds INT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                 CONCEPT_ABORT);
+    }
+}
+
+
+// FADD Floating point addition function
+void concept_fadd(ConceptStack_t *stack) {
+    float a = stack_pop_fast(stack).as.f;
+    float b = stack_pop_fast(stack).as.f;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nFADD\n");
+    printf("\t%f\tPLUS\t", a);
+    printf("%f", b);
+#endif
+
+    float c = a + b;
+
+    if (c <= FLT_MAX && c >= -FLT_MAX) {
+        stack_push_fast(stack, value_float(c));
+
+#ifdef DEBUG
+        printf("\nFADD finished, RESULT %f", c);
+#endif
+
+    } else {
+        // Exceeds maximum limit, quit
+        on_error(CONCEPT_BUFFER_OVERFLOW, "FADD Operation exceeds FLT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                 CONCEPT_ABORT);
+    }
+}
+
+// FDIV Floating point division function
+void concept_fdiv(ConceptStack_t *stack) {
+    float a = stack_pop_fast(stack).as.f;
+    float b = stack_pop_fast(stack).as.f;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nFDIV\n");
+    printf("\t%f\tDIVBY\t", a);
+    printf("%f", b);
+#endif
+
+    float c = a / b;
+
+    if (c <= FLT_MAX && c >= -FLT_MAX) {
+        stack_push_fast(stack, value_float(c));
+
+#ifdef DEBUG
+        printf("\nFDIV finished, RESULT %f", c);
+#endif
+
+    } else {
+        // Exceeds maximum limit, quit
+        on_error(CONCEPT_BUFFER_OVERFLOW, "FDIV Operation exceeds FLT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                 CONCEPT_ABORT);
+    }
+}
+
+// FMUL Floating point multiplication function
+void concept_fmul(ConceptStack_t *stack) {
+    float a = stack_pop_fast(stack).as.f;
+    float b = stack_pop_fast(stack).as.f;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nFMUL\n");
+    printf("\t%f\tTIMES\t", a);
+    printf("%f", b);
+#endif
+
+    float c = a * b;
+
+    if (c <= FLT_MAX && c >= -FLT_MAX) {
+        stack_push_fast(stack, value_float(c));
+
+#ifdef DEBUG
+        printf("\nFMUL finished, RESULT %f", c);
+#endif
+
+    } else {
+        // Exceeds maximum limit, quit
+        on_error(CONCEPT_BUFFER_OVERFLOW, "FMUL Operation exceeds FLT_MAX limit, Aborting...", CONCEPT_STATE_ERROR,
+                 CONCEPT_ABORT);
+    }
+}
+
+
+// ILT Integer Less Than comparison function
+void concept_ilt(ConceptStack_t *stack) {
+    int32_t a = stack_pop_fast(stack).as.i;
+    int32_t b = stack_pop_fast(stack).as.i;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nILT\n");
+    printf("\t%d\tLESSTHAN\t", a);
+    printf("%d", b);
+#endif
+
+    stack_push_fast(stack, value_bool(a < b));
+
+#ifdef DEBUG
+    printf("\nILT finished, RESULT %d", a < b);
+#endif
+
+}
+
+// IEQ Integer Equality comparison function
+void concept_ieq(ConceptStack_t *stack) {
+    int32_t a = stack_pop_fast(stack).as.i;
+    int32_t b = stack_pop_fast(stack).as.i;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nIEQ\n");
+    printf("\t%d\tEQUALS\t", a);
+    printf("%d", b);
+#endif
+
+    stack_push_fast(stack, value_bool(a == b));
+
+#ifdef DEBUG
+    printf("\nIEQ finished, RESULT %d", a == b);
+#endif
+}
+
+// IGT Integer Greater Than comparison function
+void concept_igt(ConceptStack_t *stack) {
+    int32_t a = stack_pop_fast(stack).as.i;
+    int32_t b = stack_pop_fast(stack).as.i;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nIGT\n");
+    printf("\t%d\tGTRTHAN\t", a);
+    printf("%d", b);
+#endif
+
+    stack_push_fast(stack, value_bool(a > b));
+
+#ifdef DEBUG
+    printf("\nIGT finished, RESULT %d", a > b);
+#endif
+}
+
+// FLT Floating point Less Than comparison function
+void concept_flt(ConceptStack_t *stack) {
+    float a = stack_pop_fast(stack).as.f;
+    float b = stack_pop_fast(stack).as.f;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nFLT\n");
+    printf("\t%f\tLESSTHAN\t", a);
+    printf("%f", b);
+#endif
+
+    stack_push_fast(stack, value_bool(a < b)); // BOOL value, NOT FLOAT!
+
+#ifdef DEBUG
+    printf("\nFLT finished, RESULT %d", a < b);
+#endif
+}
+
+// FEQ Floating point Equality comparison function
+void concept_feq(ConceptStack_t *stack) {
+    float a = stack_pop_fast(stack).as.f;
+    float b = stack_pop_fast(stack).as.f;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nFEQ\n");
+    printf("\t%f\tEQUALS\t", a);
+    printf("%f", b);
+#endif
+
+    stack_push_fast(stack, value_bool(a == b));
+
+#ifdef DEBUG
+    printf("\nFEQ finished, RESULT %d", a == b);
+#endif
+}
+
+// FGT Floating point Greater Than comparison function
+void concept_fgt(ConceptStack_t *stack) {
+    float a = stack_pop_fast(stack).as.f;
+    float b = stack_pop_fast(stack).as.f;
+
+#ifdef DEBUG // print DEBUG info
+    printf("\nFGT\n");
+    printf("\t%f\tGRTHAN\t", a);
+    printf("%f", b);
+#endif
+
+    stack_push_fast(stack, value_bool(a > b));
+
+#ifdef DEBUG
+    printf("\nFGT finished, RESULT %d", a > b);
+#endif
+}
+
+// AND
+void concept_and(ConceptStack_t *stack) {
+
+#ifdef DEBUG
+    printf("\nAND");
+#endif
+
+    BOOL p = stack_pop_fast(stack).as.i;
+    BOOL q = stack_pop_fast(stack).as.i;
+    stack_push_fast(stack, value_bool(p & q));
+
+#ifdef DEBUG
+    printf("\nAND finished, RESULT %d", p & q);
+#endif
+}
+
+// OR
+void concept_or(ConceptStack_t *stack) {
+
+#ifdef DEBUG
+    printf("\nOR");
+#endif
+
+    BOOL p = stack_pop_fast(stack).as.i;
+    BOOL q = stack_pop_fast(stack).as.i;
+    stack_push_fast(stack, value_bool(p | q));
+
+#ifdef DEBUG
+    printf("\nOR finished, RESULT %d", p | q);
+#endif
+}
+
+// XOR
+void concept_xor(ConceptStack_t *stack) {
+
+    int32_t p = stack_pop_fast(stack).as.i;
+    int32_t q = stack_pop_fast(stack).as.i;
+
+#ifdef DEBUG
+    printf("\nXOR (%d XOR %d)", p, q);
+#endif
+
+    BOOL xor = (p & (!q)) | ((!p) & q);
+    stack_push_fast(stack, value_bool(xor));
+
+#ifdef DEBUG
+    printf("\nXOR finished, RESULT %d", xor);
+#endif
+}
+
+// NE
+void concept_ne(ConceptStack_t *stack) {
+
+    int32_t p = stack_pop_fast(stack).as.i;
+
+#ifdef DEBUG
+    printf("\nNE (!%d)", p);
+#endif
+
+    stack_push_fast(stack, value_bool(!p));
+
+#ifdef DEBUG
+    printf("\nNE finished, RESULT %d", !p);
+#endif
+}
+
+// IF
+void concept_if(ConceptStack_t *stack) {
+
+    int32_t p = stack_pop_fast(stack).as.i;
+    int32_t q = stack_pop_fast(stack).as.i;
+
+#ifdef DEBUG
+    printf("\nIF(Boolean Algebra Operation), %d->%d", p, q);
+#endif
+
+    BOOL cp_if = ((!p) | q);
+    stack_push_fast(stack, value_bool(cp_if));
+
+#ifdef DEBUG
+    printf("\nIF (Boolean Algebra Operation) finished, RESULT %d", cp_if);
+#endif
+}
+
+void concept_cconst(ConceptStack_t *stack, char c) {
+
+#ifdef DEBUG
+    printf("\nCCONST %c", c);
+#endif
+
+    stack_push_fast(stack, value_char(c));
+}
+
+void concept_iconst(ConceptStack_t *stack, int32_t i) {
+
+#ifdef DEBUG
+    printf("\nICONST %d", i);
+#endif
+
+    stack_push_fast(stack, value_int(i));
+}
+
+void concept_sconst(ConceptStack_t *stack, char *s) {
+
+#ifdef DEBUG
+    printf("\nSCONST\n");
+    printf("Dumped Contents\n");
+    printf("-=-=-=-=-=-=-=-=-\n");
+    printf("%s", s);
+    printf("\n\n");
+#endif
+
+    // the string itself stays in string_pool, only the pointer is pushed
+    stack_push_fast(stack, value_string(s));
+}
+
+void concept_fconst(ConceptStack_t *stack, float f) {
+
+#ifdef DEBUG
+    printf("\nFCONST %f", f);
+#endif
+
+    stack_push_fast(stack, value_float(f));
+}
+
+
+void concept_bconst(ConceptStack_t *stack, BOOL b) {
+
+#ifdef DEBUG
+    printf("\nBCONST %d", b);
+#endif
+
+    stack_push_fast(stack, value_bool(b));
+}
+
+void concept_vconst(ConceptStack_t *stack, void *v) {
+
+#ifdef DEBUG
+    printf("\nVCONST bla bla bla... @ addr %p", v);
+#endif
+
+    stack_push_fast(stack, value_void(v));
+}
+
+// Print a value the way print shows it, without a newline
+void print_value(const ConceptValue_t *v) {
+    switch (v->type) {
+        case CONCEPT_VALUE_FLOAT:
+            printf("%f", v->as.f);
+            break;
+        case CONCEPT_VALUE_CHAR:
+            printf("%c", v->as.c);
+            break;
+        case CONCEPT_VALUE_STRING:
+            printf("%s", v->as.s);
+            break;
+        case CONCEPT_VALUE_OBJECT:
+            printf("%s", v->as.o->data);
+            break;
+        case CONCEPT_VALUE_VOID:
+            printf("null");
+            break;
+        default:
+            printf("%d", v->as.i);
+            break;
+    }
+}
+
+void concept_print(ConceptStack_t *stack) {
+    if (stack_is_empty(stack))
+        return;
+    print_value(&stack->operand_stack[stack->top]);
+}
+
+ConceptValue_t concept_pop(ConceptStack_t *stack) {
+    return stack_pop_fast(stack);
+}
+
+void concept_incr(ConceptStack_t *stack) {
+    // modified in place, the slot keeps its type
+    stack_peek_fast(stack)->as.i++;
+}
+
+void concept_decr(ConceptStack_t *stack) {
+    stack_peek_fast(stack)->as.i--;
+}
+
+void concept_swap(ConceptStack_t *stack) {
+    ConceptValue_t i = stack_pop_fast(stack);
+    ConceptValue_t j = stack_pop_fast(stack);
+
+    stack_push_fast(stack, i);
+    stack_push_fast(stack, j);
+}
+
+void concept_dupl(ConceptStack_t *stack) {
+    // values are copied; a heap string is shared, which the collector handles
+    stack_push_fast(stack, *stack_peek_fast(stack));
+}
+
+// Characters of a string constant or heap string
+static const char *value_chars(const ConceptValue_t *v) {
+    if (v->type == CONCEPT_VALUE_STRING)
+        return v->as.s;
+    if (v->type == CONCEPT_VALUE_OBJECT && v->as.o->kind == CONCEPT_OBJECT_STRING)
+        return v->as.o->data;
+    on_error(CONCEPT_INVALID_TYPE, "SCAT operand is not a string.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    return NULL;
+}
+
+// SCAT String concatenation: pushes the lower string followed by the top one, as a new heap string
+void concept_scat(ConceptStack_t *stack) {
+    // allocate while both operands are still on the stack, where the collector can see (and move) them
+    size_t la = strlen(value_chars(&stack->operand_stack[stack->top]));
+    size_t lb = strlen(value_chars(&stack->operand_stack[stack->top - 1]));
+    ConceptObject_t *o = gc_alloc(CONCEPT_OBJECT_STRING, la + lb + 1);
+
+    ConceptValue_t a = stack_pop_fast(stack);
+    ConceptValue_t b = stack_pop_fast(stack);
+    memcpy(o->data, value_chars(&b), lb);
+    memcpy(o->data + lb, value_chars(&a), la + 1);
+
+#ifdef DEBUG
+    printf("\nSCAT %s", o->data);
+#endif
+
+    stack_push_fast(stack, value_object(o));
+}
+
+/*
+ * Opcode descriptor table
+ */
+
+const ConceptOpcode_t concept_opcodes[CONCEPT_OPCODE_MAX] = {
+#define CONCEPT_OPCODE(name, mnemonic, code, payload, pops, pushes, handler) \
+        [code] = {mnemonic, code, payload, pops, pushes, (ConceptHandler_t) handler, 1},
+#define CONCEPT_SUPER(name, mnemonic, code, payload, pops, pushes, first, second) \
+        [code] = {mnemonic, code, payload, pops, pushes, NULL, 2},
+#include "opcodes.def"
+};
+
+// First half of each superinstruction, 0 for everything else
+const int32_t concept_super_first[CONCEPT_OPCODE_MAX] = {
+#define CONCEPT_OPCODE(name, mnemonic, code, payload, pops, pushes, handler)
+#define CONCEPT_SUPER(name, mnemonic, code, payload, pops, pushes, first, second) [code] = CONCEPT_##first,
+#include "opcodes.def"
+};
+
+const ConceptOpcode_t *opcode_lookup(const char *mnemonic, size_t len) {
+    const ConceptOpcodeSlot_t *slot = &concept_opcode_hash_slots[
+            concept_opcode_hash(mnemonic, len, CONCEPT_OPCODE_HASH_SEED) & (CONCEPT_OPCODE_HASH_SIZE - 1)];
+
+    // one comparison to reject mnemonics that merely hash into an occupied slot
+    if (slot->code < 0 || strncmp(slot->mnemonic, mnemonic, len) || slot->mnemonic[len] != '\0')
+        return NULL;
+    return &concept_opcodes[slot->code];
+}
+
+int32_t *go_to(int32_t line_number) { // TODO TODO
+
+    int32_t cumulative_line_count = 0;
+
+
+    // handle the special case where the goto resides in the main procedure.
+    // not a good solution, TODO have ea better one!
+    if (line_number >= cumulative_line_count && line_number <= procedure_length_table[0]) {
+        // in this procedure!
+        int32_t pc_line = (line_number - cumulative_line_count);
+        int32_t *rtn = (int32_t *) arena_alloc(&program_arena, sizeof(int32_t) * 3);
+        rtn[0] = 0;
+        rtn[1] = pc_line;
+        rtn[2] = (-1);
+        return rtn;
+    }
+
+    for (int32_t findex = 0; findex < procedure_length_table_length; findex++) {
+        cumulative_line_count += procedure_length_table[findex];
+        int32_t next_cum_len = cumulative_line_count + procedure_length_table[findex + 1];
+        if (line_number >= cumulative_line_count && line_number <= next_cum_len) {
+            // in this procedure!
+            int32_t pc_line = (line_number - cumulative_line_count);
+            int32_t *rtn = (int32_t *) arena_alloc(&program_arena, sizeof(int32_t) * 3);
+            rtn[0] = findex;
+            rtn[1] = pc_line;
+            rtn[2] = (-1);
+            return rtn;
+        }
+    }
+    // not a valid go to
+    on_error(CONCEPT_COMPILER_ERROR, " goto statement not valid.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    return 0; // to satisfy IDE
+}
+
+/*
+ * File Reader Utilities and Lexer
+ */
+
+/*
+ * Dispatch engine
+ * ---------------
+ * The same handler bodies are compiled either as the cases of a switch loop (portable) or, with THREADED_DISPATCH,
+ * as labels of a direct-threaded interpreter: thread_procedures() turns every instruction into its handler address
+ * and each handler jumps straight to the next one.
+ */
+
+#ifdef DEBUG
+#define DISPATCH_TRACE() printf("\n eval: Dispatching instruction %d @ index %d: %d", i, index, program[index][i].instr)
+#else
+#define DISPATCH_TRACE()
+#endif
+
+#ifdef MEASURE_OPCODE_PAIRS
+// opcode_pairs[a][b]: how often b was executed right after a
+uint64_t opcode_pairs[CONCEPT_OPCODE_MAX][CONCEPT_OPCODE_MAX];
+int32_t opcode_pair_prev = CONCEPT_HALT;
+#define PAIR_COUNT() \
+    do { \
+        if (i < procedure_length_table[index]) { \
+            int32_t op = program[index][i].instr; \
+            opcode_pairs[opcode_pair_prev][op]++; \
+            opcode_pair_prev = op; \
+        } \
+    } while (0)
+#else
+#define PAIR_COUNT()
+#endif
+
+#ifdef THREADED_DISPATCH
+#define DISPATCH_MODE_NAME "THREADED"
+#define TARGET(op) do_##op
+#define DISPATCH() \
+    do { \
+        void *handler; \
+        DISPATCH_TRACE(); \
+        PAIR_COUNT(); \
+        STATS_DISPATCH(); \
+        PROFILE_PUBLISH(index, i); \
+        handler = handlers[i]; \
+        goto *handler; \
+    } while (0)
+#define NEXT() \
+    do { \
+        i++; \
+        DISPATCH(); \
+    } while (0)
+
+// Handler addresses published by eval(), indexed by opcode
+void **dispatch_labels = NULL;
+void *dispatch_label_end;
+void *dispatch_label_unknown;
+// Per procedure handler address arrays, each terminated by the end-of-procedure handler
+void ***threaded_program;
+#define SET_PROCEDURE(p) (index = (p), handlers = threaded_program[index])
+#else
+#define DISPATCH_MODE_NAME "SWITCH"
+#define TARGET(op) case op
+#define NEXT() break
+#define SET_PROCEDURE(p) (index = (p))
+#endif
+
+/*
+ * Execution statistics
+ * --------------------
+ * With --stats FILE, eval() counts every instruction it dispatches, per opcode and per procedure, and charges the
+ * time until the next dispatch to it: TSC cycles on x86-64, clock_gettime() nanoseconds elsewhere. Procedure
+ * invocations are counted by both interpreters; what runs as native code is not seen, so the report is most
+ * useful with the stack tier. The report is written as JSON when the program ends, also when it ends by an error.
+ * Without the flag the only cost is one predictable branch per instruction.
+ */
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <x86intrin.h>
+#define STATS_CLOCK_NAME "tsc"
+#define STATS_TICK() __rdtsc()
+#else
+#define STATS_CLOCK_NAME "ns"
+#define STATS_TICK() stats_now()
+#endif
+
+// Where --stats writes its report, NULL when statistics are off
+char *stats_path = NULL;
+// Collected while the program runs, NULL otherwise
+ConceptStats_t *concept_stats = NULL;
+
+uint64_t stats_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// Charge the ticks up to now to the instruction dispatched last
+static inline void stats_charge(ConceptStats_t *stats, uint64_t now) {
+    if (stats->last_opcode >= 0) {
+        stats->opcode_ticks[stats->last_opcode] += now - stats->last_tick;
+        stats->procedure_ticks[stats->last_procedure] += now - stats->last_tick;
+    }
+    stats->last_tick = now;
+}
+
+// Counted in the dispatch of eval(), where stats caches concept_stats
+#define STATS_DISPATCH() \
+    do { \
+        if (stats != NULL && i < procedure_length_table[index]) { \
+            stats_charge(stats, STATS_TICK()); \
+            stats->last_opcode = program[index][i].instr; \
+            stats->last_procedure = index; \
+            stats->opcode_counts[stats->last_opcode]++; \
+            stats->procedure_instructions[index]++; \
+        } \
+    } while (0)
+
+static void stats_write_string(FILE *fp, const char *s) {
+    fputc('"', fp);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')
+            fprintf(fp, "\\%c", *s);
+        else if ((unsigned char) *s < 0x20)
+            fprintf(fp, "\\u%04x", (unsigned char) *s);
+        else
+            fputc(*s, fp);
+    }
+    fputc('"', fp);
+}
+
+// Most expensive opcode first
+static int stats_compare_opcodes(const void *x, const void *y) {
+    uint64_t a = concept_stats->opcode_ticks[*(const int32_t *) x];
+    uint64_t b = concept_stats->opcode_ticks[*(const int32_t *) y];
+    return a < b ? 1 : a > b ? -1 : *(const int32_t *) x - *(const int32_t *) y;
+}
+
+static void stats_report(ConceptStats_t *stats, uint64_t ticks, uint64_t wall_ns) {
+    FILE *fp = fopen(stats_path, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "\n[CONCEPTUM-Runtime] Could not write statistics to %s.\n", stats_path);
+        return;
+    }
+    uint64_t instructions = 0;
+    for (int32_t op = 0; op < CONCEPT_OPCODE_MAX; op++)
+        instructions += stats->opcode_counts[op];
+
+    fprintf(fp, "{\n  \"tier\": \"%s\",\n  \"dispatch\": \"%s\",\n  \"clock\": \"%s\",\n", stats->tier,
+            DISPATCH_MODE_NAME, STATS_CLOCK_NAME);
+    fprintf(fp, "  \"wall_ns\": %" PRIu64 ",\n  \"ticks\": %" PRIu64 ",\n  \"instructions\": %" PRIu64 ",\n",
+            wall_ns, ticks, instructions);
+
+    int32_t order[CONCEPT_OPCODE_MAX], used = 0;
+    for (int32_t op = 0; op < CONCEPT_OPCODE_MAX; op++)
+        if (stats->opcode_counts[op])
+            order[used++] = op;
+    qsort(order, (size_t) used, sizeof(int32_t), stats_compare_opcodes);
+    fprintf(fp, "  \"opcodes\": [");
+    for (int32_t k = 0; k < used; k++) {
+        fprintf(fp, "%s\n    {\"opcode\": \"%s\", \"code\": %d, \"count\": %" PRIu64 ", \"ticks\": %" PRIu64 "}",
+                k ? "," : "", concept_opcodes[order[k]].mnemonic, order[k], stats->opcode_counts[order[k]],
+                stats->opcode_ticks[order[k]]);
+    }
+    fprintf(fp, "%s],\n  \"procedures\": [", used ? "\n  " : "");
+    for (int32_t p = 0; p < stats->procedure_count; p++) {
+        fprintf(fp, "%s\n    {\"name\": ", p ? "," : "");
+        stats_write_string(fp, procedure_call_table[p]);
+        fprintf(fp, ", \"calls\": %" PRIu64 ", \"instructions\": %" PRIu64 ", \"ticks\": %" PRIu64 "}",
+                stats->procedure_calls[p], stats->procedure_instructions[p], stats->procedure_ticks[p]);
+    }
+    fprintf(fp, "%s]\n}\n", stats->procedure_count ? "\n  " : "");
+    fclose(fp);
+}
+
+// Stop counting and write the report; the program tables have to be still loaded
+void stats_stop() {
+    ConceptStats_t *stats = concept_stats;
+    if (stats == NULL)
+        return;
+    uint64_t now = STATS_TICK();
+    stats_charge(stats, now);
+    stats_report(stats, now - stats->start_tick, stats_now() - stats->start_ns);
+    concept_stats = NULL;
+    free(stats->procedure_calls);
+    free(stats->procedure_instructions);
+    free(stats->procedure_ticks);
+    free(stats);
+}
+
+// Start counting for the loaded program when --stats was given
+void stats_start(const char *tier) {
+    if (stats_path == NULL)
+        return;
+    ConceptStats_t *stats = calloc(1, sizeof(ConceptStats_t));
+    int32_t count = procedure_length_table_length;
+    stats->procedure_calls = calloc((size_t) count + 1, sizeof(uint64_t));
+    stats->procedure_instructions = calloc((size_t) count + 1, sizeof(uint64_t));
+    stats->procedure_ticks = calloc((size_t) count + 1, sizeof(uint64_t));
+    if (stats->procedure_calls == NULL || stats->procedure_instructions == NULL || stats->procedure_ticks == NULL)
+        on_error(CONCEPT_GENERAL_ERROR, "Out of memory for statistics.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    stats->procedure_count = count;
+    stats->last_opcode = -1;
+    stats->tier = tier;
+    stats->start_ns = stats_now();
+    stats->start_tick = stats->last_tick = STATS_TICK();
+    concept_stats = stats;
+
+    static BOOL registered = 0;
+    if (!registered) { // a run ended by on_error() or halt still gets its report
+        atexit(stats_stop);
+        registered = 1;
+    }
+}
+
+/*
+ * Sampling profiler
+ * -----------------
+ * With --profile FILE, a SIGPROF timer on the CPU time of the interpreter thread takes a sample every
+ * CONCEPT_PROFILE_INTERVAL microseconds: the procedure and pc the interpreter last published, and the callers
+ * from the frame records. At exit the samples are written as folded stacks, "main;fib;fib;iadd@7 42" per
+ * distinct stack, which flamegraph.pl and similar tools read directly. The interpreters publish their position
+ * with two stores per instruction while profiling. Compiled code does not publish: entering it publishes [jit],
+ * and its calls write the caller's frame record only when the code was compiled for a profiled run. A stack then
+ * names every procedure but the innermost compiled one, "main;fib;fib;[jit] 42".
+ */
+
+#ifndef CONCEPT_PROFILE_INTERVAL
+#define CONCEPT_PROFILE_INTERVAL 1000 // microseconds of CPU time
+#endif
+#ifndef CONCEPT_PROFILE_SAMPLES
+#define CONCEPT_PROFILE_SAMPLES 65536 // later samples are only counted as dropped
+#endif
+#ifndef CONCEPT_PROFILE_DEPTH
+#define CONCEPT_PROFILE_DEPTH 64 // innermost procedures kept per sample
+#endif
+#if defined(SIGEV_THREAD_ID) && !defined(sigev_notify_thread_id)
+#define sigev_notify_thread_id _sigev_un._tid // glibc before 2.35 leaves it to the kernel headers
+#endif
+
+typedef struct {
+    int32_t depth;
+    int32_t pc; // in the innermost procedure, -1 if unknown
+    int32_t procedures[CONCEPT_PROFILE_DEPTH]; // outermost first
+} ConceptProfileSample_t;
+
+// Where --profile writes its folded stacks, NULL when profiling is off
+char *profile_path = NULL;
+// Nonzero while the timer runs; the interpreters publish their position only then
+volatile sig_atomic_t profiling = 0;
+// Published by the interpreters, read by the signal handler
+volatile int32_t profile_procedure = -1;
+volatile int32_t profile_pc = -1;
+
+struct {
+    ConceptFrameStack_t *frames;
+    ConceptProfileSample_t *samples;
+    volatile int32_t count;
+    volatile int32_t dropped;
+    timer_t timer;
+} concept_profile;
+
+// SIGPROF handler: copy the published position and the callers of the frame records, nothing else
+static void profile_tick(int signal) {
+    (void) signal;
+    if (concept_profile.count >= CONCEPT_PROFILE_SAMPLES) {
+        concept_profile.dropped++;
+        return;
+    }
+    ConceptProfileSample_t *sample = &concept_profile.samples[concept_profile.count];
+    ConceptFrameStack_t *frames = concept_profile.frames;
+    int32_t top = frames->top < frames->size ? frames->top : frames->size - 1;
+    int32_t first = top - (CONCEPT_PROFILE_DEPTH - 2) > 0 ? top - (CONCEPT_PROFILE_DEPTH - 2) : 0;
+    int32_t depth = 0;
+    for (int32_t k = first; k <= top; k++)
+        sample->procedures[depth++] = frames->frames[k].procedure;
+    sample->procedures[depth++] = profile_procedure;
+    sample->depth = depth;
+    sample->pc = profile_pc;
+    concept_profile.count++;
+}
+
+static int profile_compare_samples(const void *x, const void *y) {
+    const ConceptProfileSample_t *a = x, *b = y;
+    int32_t depth = a->depth < b->depth ? a->depth : b->depth;
+    for (int32_t k = 0; k < depth; k++)
+        if (a->procedures[k] != b->procedures[k])
+            return a->procedures[k] < b->procedures[k] ? -1 : 1;
+    if (a->depth != b->depth)
+        return a->depth < b->depth ? -1 : 1;
+    return a->pc < b->pc ? -1 : a->pc > b->pc;
+}
+
+static void profile_write_frame(FILE *fp, int32_t p) {
+    if (p >= 0 && p < procedure_length_table_length)
+        fputs(procedure_call_table[p], fp);
+    else
+        fputs(p == CONCEPT_PROFILE_JIT ? "[jit]" : "[unknown]", fp);
+}
+
+// Stop sampling and write the folded stacks; the program tables have to be still loaded
+void profile_stop() {
+    if (!profiling)
+        return;
+    struct itimerspec off;
+    memset(&off, 0, sizeof(off));
+    timer_settime(concept_profile.timer, 0, &off, NULL);
+    timer_delete(concept_profile.timer);
+    profiling = 0;
+
+    FILE *fp = fopen(profile_path, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "\n[CONCEPTUM-Runtime] Could not write profile to %s.\n", profile_path);
+    } else {
+        int32_t count = concept_profile.count;
+        qsort(concept_profile.samples, (size_t) count, sizeof(ConceptProfileSample_t), profile_compare_samples);
+        for (int32_t s = 0; s < count;) {
+            ConceptProfileSample_t *sample = &concept_profile.samples[s];
+            int32_t same = 1;
+            while (s + same < count && !profile_compare_samples(sample, &concept_profile.samples[s + same]))
+                same++;
+            for (int32_t k = 0; k < sample->depth; k++) {
+                if (k)
+                    fputc(';', fp);
+                profile_write_frame(fp, sample->procedures[k]);
+            }
+            int32_t p = sample->procedures[sample->depth - 1];
+            if (p >= 0 && p < procedure_length_table_length && sample->pc >= 0
+                && sample->pc < procedure_length_table[p])
+                fprintf(fp, ";%s@%d", concept_opcodes[program[p][sample->pc].instr].mnemonic, sample->pc);
+            fprintf(fp, " %d\n", same);
+            s += same;
+        }
+        fclose(fp);
+    }
+    if (concept_profile.dropped)
+        fprintf(stderr, "\n[CONCEPTUM-Runtime] Profile buffer full, %d samples dropped.\n", concept_profile.dropped);
+    free(concept_profile.samples);
+    concept_profile.samples = NULL;
+}
+
+// Start sampling the calling thread when --profile was given
+void profile_start(ConceptFrameStack_t *frames) {
+    if (profile_path == NULL)
+        return;
+    concept_profile.frames = frames;
+    concept_profile.count = 0;
+    concept_profile.dropped = 0;
+    concept_profile.samples = malloc(sizeof(ConceptProfileSample_t) * CONCEPT_PROFILE_SAMPLES);
+    if (concept_profile.samples == NULL)
+        on_error(CONCEPT_GENERAL_ERROR, "Out of memory for the profiler.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    profile_procedure = -1;
+    profile_pc = -1;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = profile_tick;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, NULL);
+
+    // the thread's own CPU time, so the background compiler does not count, and its signal goes to this thread:
+    // a process-directed one may land on the compiler, which samples the frames of a thread it is not running
+    struct sigevent event;
+    memset(&event, 0, sizeof(event));
+#ifdef SIGEV_THREAD_ID
+    event.sigev_notify = SIGEV_THREAD_ID;
+    event.sigev_notify_thread_id = (pid_t) syscall(SYS_gettid);
+#else
+    event.sigev_notify = SIGEV_SIGNAL; // the compiler blocks SIGPROF, so it still lands here
+#endif
+    event.sigev_signo = SIGPROF;
+    if (timer_create(CLOCK_THREAD_CPUTIME_ID, &event, &concept_profile.timer) != 0) {
+        fprintf(stderr, "\n[CONCEPTUM-Runtime] Could not start the profiler timer.\n");
+        free(concept_profile.samples);
+        concept_profile.samples = NULL;
+        return;
+    }
+    struct itimerspec interval;
+    interval.it_interval.tv_sec = CONCEPT_PROFILE_INTERVAL / 1000000;
+    interval.it_interval.tv_nsec = (CONCEPT_PROFILE_INTERVAL % 1000000) * 1000L;
+    interval.it_value = interval.it_interval;
+    profiling = 1;
+    timer_settime(concept_profile.timer, 0, &interval, NULL);
+
+    static BOOL registered = 0;
+    if (!registered) { // like the statistics, a run ended by an error still gets its profile
+        atexit(profile_stop);
+        registered = 1;
+    }
+}
+
+// Enter a procedure: its arguments are the topmost operands of the caller and become its first slots in place,
+// the remaining local slots start out void, and its own operands begin right above them. Room for the slots and
+// the procedure's proven maximum depth is checked here once, so its instructions need no bounds checks.
+#define PROCEDURE_ENTER(p) \
+    do { \
+        int32_t callee = (p); \
+        int32_t nargs = procedure_args_table[callee]; \
+        int32_t slots = FRAME_SLOTS(callee); \
+        if (stack->top + 1 < nargs) \
+            on_error(CONCEPT_INVALID_PARAMETER, "Not enough arguments for call.", CONCEPT_STATE_ERROR, \
+                     CONCEPT_WARN_EXITNOW); \
+        base = (int32_t) (stack->operand_stack - stack_bottom) + stack->top + 1 - nargs; \
+        if (base + slots + procedure_max_depth_table[callee] > stack_size) \
+            on_error(CONCEPT_STACK_OVERFLOW, "Stack is full, operation abort.", CONCEPT_STATE_ERROR, \
+                     CONCEPT_WARN_EXITNOW); \
+        locals = stack_bottom + base; \
+        for (int32_t slot = nargs; slot < slots; slot++) \
+            locals[slot] = value_void(NULL); \
+        stack->operand_stack = locals + slots; \
+        stack->size = stack_size - base - slots; \
+        stack->top = -1; \
+        SET_PROCEDURE(callee); \
+        STATS_CALL(stats, callee); \
+    } while (0)
+
+// Leave the current procedure: pop its return value, drop its slots and whatever operands it left, restore the
+// caller's frame and push the value there. Returning from the entry procedure leaves eval().
+#define PROCEDURE_RETURN() \
+    do { \
+        ConceptValue_t ret = stack_pop(stack); \
+        if (frames->top <= frames_floor) { \
+            stack->operand_stack = stack_bottom; \
+            stack->size = stack_size; \
+            stack->top = base - 1; \
+            return ret; \
+        } \
+        ConceptFrame_t *frame = &frames->frames[(frames->top)--]; \
+        int32_t caller_operands = frame->stack_base + FRAME_SLOTS(frame->procedure); \
+        stack->top = base - caller_operands - 1; \
+        stack->operand_stack = stack_bottom + caller_operands; \
+        stack->size = stack_size - caller_operands; \
+        base = frame->stack_base; \
+        locals = stack_bottom + base; \
+        SET_PROCEDURE(frame->procedure); \
+        i = frame->return_pc; \
+        stack_push_fast(stack, ret); \
+    } while (0)
+
+// A jump back to target in the running procedure, counted when tiering. Once the tiering compiler has published
+// an entry there, the rest of the invocation runs natively on the same frame: the register code keeps its
+// operands exactly where eval() does at a jump target. Not a do-while, so that NEXT() can leave the handler.
+#define BACK_EDGE(target) \
+    if (tier_threshold && (target) <= i) { \
+        if (++procedure_backedge_counts[index] + procedure_call_counts[index] == tier_threshold) \
+            tier_request(index); \
+        ConceptJitProcedure_t *osr = atomic_load_explicit(&jit_osr[index], memory_order_acquire); \
+        if (osr != NULL && osr[target] != NULL) { \
+            int32_t slots = FRAME_SLOTS(index); \
+            for (int32_t r = slots + stack->top + 1; r < slots + procedure_max_depth_table[index]; r++) \
+                locals[r] = value_void(NULL); \
+            PROFILE_PUBLISH(CONCEPT_PROFILE_JIT, -1); \
+            osr[target](locals); \
+            ConceptValue_t result = locals[0]; \
+            stack->operand_stack = locals + slots; \
+            stack->size = stack_size - base - slots; \
+            stack->top = -1; \
+            stack_push_fast(stack, result); \
+            PROCEDURE_RETURN(); \
+            NEXT(); \
+        } \
+    }
+
+// Iterating event loop
+// Calls and returns are handled inside the loop: every procedure invocation pushes a ConceptFrame_t and sees
+// the part of the one contiguous operand stack above its caller's operands, so no C recursion takes place.
+// The stack view has to be the whole stack, its operands being the arguments of procedure index; native code
+// calls back in here for procedures still interpreted, which leave eval() at the frames found on entry.
+// With THREADED_DISPATCH, a negative index only publishes the handler addresses into dispatch_labels.
+ConceptValue_t
+eval(int32_t index, ConceptStack_t *stack, ConceptValue_t *globals, ConceptFrameStack_t *frames,
+     int32_t start_by) {
+
+#ifdef THREADED_DISPATCH
+    static void *labels[CONCEPT_OPCODE_MAX] = {
+#define CONCEPT_OPCODE(name, mnemonic, code, payload, pops, pushes, handler) [code] = &&do_CONCEPT_##name,
+#include "opcodes.def"
+    };
+
+    if (index < 0) {
+        for (int32_t op = 0; op < CONCEPT_OPCODE_MAX; op++)
+            if (labels[op] == NULL)
+                labels[op] = &&do_unknown;
+        dispatch_labels = labels;
+        dispatch_label_end = &&do_end_of_procedure;
+        dispatch_label_unknown = &&do_unknown;
+        return value_void(NULL);
+    }
+#endif
+
+#ifdef DEBUG
+    printf(ANSI_COLOR_RESET ANSI_COLOR_MAGENTA "\n\nConceptum: Welcome to the eval() Loop. FYI: Curr index %d, starting by line %d \n",
+           index,
+           start_by);
+#endif
+
+    if (program[0] == NULL)
+        on_error(CONCEPT_COMPILER_ERROR, "struct ConceptInstruction_t blank.", CONCEPT_ABORT,
+                 CONCEPT_STATE_CATASTROPHE);
+
+    // the whole operand stack; each frame only sees its slots and the operands above them
+    ConceptValue_t *stack_bottom = stack->operand_stack;
+    int32_t stack_size = stack->size;
+    int32_t base;
+    ConceptValue_t *locals;
+    int32_t frames_floor = frames->top;
+    ConceptStats_t *stats = concept_stats;
+    BOOL profiled = profiling;
+
+#ifdef THREADED_DISPATCH
+    void **handlers;
+    PROCEDURE_ENTER(index);
+    int32_t i = start_by;
+    DISPATCH();
+#else
+    PROCEDURE_ENTER(index);
+    for (int32_t i = start_by;; i++) {
+
+        if (i >= procedure_length_table[index]) { // fell off the end of the procedure
+#ifdef DEBUG
+            printf("\neval: Naturally RETURNing to parent function call...\n");
+#endif
+            PROCEDURE_RETURN();
+            continue;
+        }
+
+        DISPATCH_TRACE();
+        PAIR_COUNT();
+        STATS_DISPATCH();
+        PROFILE_PUBLISH(index, i);
+
+        // fetch instruction
+        int instr = program[index][i].instr;
+        switch (instr) {
+#endif
+            TARGET(CONCEPT_IADD):
+                concept_iadd(stack);
+                NEXT();
+            TARGET(CONCEPT_IDIV):
+                concept_idiv(stack);
+                NEXT();
+            TARGET(CONCEPT_IMUL):
+                concept_imul(stack);
+                NEXT();
+            TARGET(CONCEPT_FADD):
+                concept_fadd(stack);
+                NEXT();
+            TARGET(CONCEPT_FDIV):
+                concept_fdiv(stack);
+                NEXT();
+            TARGET(CONCEPT_FMUL):
+                concept_fmul(stack);
+                NEXT();
+            TARGET(CONCEPT_ILT):
+                concept_ilt(stack);
+                NEXT();
+            TARGET(CONCEPT_IEQ):
+                concept_ieq(stack);
+                NEXT();
+            TARGET(CONCEPT_IGT):
+                concept_igt(stack);
+                NEXT();
+            TARGET(CONCEPT_FLT):
+                concept_flt(stack);
+                NEXT();
+            TARGET(CONCEPT_FEQ):
+                concept_feq(stack);
+                NEXT();
+            TARGET(CONCEPT_FGT):
+                concept_fgt(stack);
+                NEXT();
+            TARGET(CONCEPT_AND):
+                concept_and(stack);
+                NEXT();
+            TARGET(CONCEPT_OR):
+                concept_or(stack);
+                NEXT();
+            TARGET(CONCEPT_XOR):
+                concept_xor(stack);
+                NEXT();
+            TARGET(CONCEPT_NE):
+                concept_ne(stack);
+                NEXT();
+            TARGET(CONCEPT_IF):
+                concept_if(stack);
+                NEXT();
+            TARGET(CONCEPT_CCONST):
+                concept_cconst(stack, (program[index][i].as.c));
+                NEXT();
+            TARGET(CONCEPT_ICONST):
+                concept_iconst(stack, (program[index][i].as.i));
+                NEXT();
+            TARGET(CONCEPT_SCONST):
+                concept_sconst(stack, string_pool + program[index][i].as.s);
+                NEXT();
+            TARGET(CONCEPT_FCONST):
+                concept_fconst(stack, (program[index][i].as.f));
+                NEXT();
+            TARGET(CONCEPT_BCONST):
+                concept_bconst(stack, (program[index][i].as.i));
+                NEXT();
+            TARGET(CONCEPT_VCONST):
+                NEXT();
+            TARGET(CONCEPT_PRINT):
+                concept_print(stack);
+                NEXT();
+            TARGET(CONCEPT_POP):
+                stack_pop_fast(stack);
+                NEXT();
+            TARGET(CONCEPT_GLOAD):
+                stack_push_fast(stack, globals[program[index][i].as.i]);
+                NEXT();
+            TARGET(CONCEPT_GSTORE):
+                globals[program[index][i].as.i] = stack_pop_fast(stack);
+                NEXT();
+            TARGET(CONCEPT_CALL): {
+#ifdef DEBUG
+                printf("\nFCALL\t:%d (Name: %s)", (program[index][i].as.i),
+                       procedure_call_table[program[index][i].as.i]);
+#endif
+                if (frames->top >= frames->size - 1)
+                    on_error(CONCEPT_STACK_OVERFLOW, "Call stack is full, operation abort.", CONCEPT_STATE_ERROR,
+                             CONCEPT_WARN_EXITNOW);
+                if (tier_threshold) {
+                    int32_t callee = program[index][i].as.i;
+                    if (++procedure_call_counts[callee] + procedure_backedge_counts[callee] == tier_threshold)
+                        tier_request(callee);
+                    ConceptJitProcedure_t native = atomic_load_explicit(&jit_program[callee], memory_order_acquire);
+                    int32_t first = stack->top + 1 - procedure_args_table[callee];
+                    if (native != NULL && first >= 0) { // the native's own calls write no records unless profiled
+                        ConceptValue_t *operands = stack->operand_stack;
+                        int32_t size = stack->size;
+                        frames->frames[frames->top + 1].procedure = index; // the caller, for the profiler
+                        frames->frames[frames->top + 1].return_pc = i;
+                        frames->top++;
+                        PROFILE_PUBLISH(CONCEPT_PROFILE_JIT, -1);
+                        native(operands + first);
+                        frames->top--;
+                        stack->operand_stack = operands;
+                        stack->size = size;
+                        stack->top = first;
+                        NEXT();
+                    }
+                }
+                ConceptFrame_t *frame = &frames->frames[++(frames->top)];
+                frame->return_pc = i;
+                frame->procedure = index;
+                frame->stack_base = base;
+
+                PROCEDURE_ENTER(program[index][i].as.i);
+                i = -1;
+                NEXT();
+            }
+            TARGET(CONCEPT_TAILCALL): {
+#ifdef DEBUG
+                printf("\nTAILCALL\t:%d (Name: %s)", (program[index][i].as.i),
+                       procedure_call_table[program[index][i].as.i]);
+#endif
+                // the callee takes over this frame: its arguments move down to the first slots
+                int32_t tail = program[index][i].as.i;
+                int32_t nargs = procedure_args_table[tail];
+                if (stack->top + 1 < nargs)
+                    on_error(CONCEPT_INVALID_PARAMETER, "Not enough arguments for call.", CONCEPT_STATE_ERROR,
+                             CONCEPT_WARN_EXITNOW);
+                memmove(locals, stack->operand_stack + stack->top + 1 - nargs, sizeof(ConceptValue_t) * nargs);
+                stack->operand_stack = locals;
+                stack->top = nargs - 1;
+                if (tier_threshold) {
+                    if (++procedure_call_counts[tail] + procedure_backedge_counts[tail] == tier_threshold)
+                        tier_request(tail);
+                    ConceptJitProcedure_t native = atomic_load_explicit(&jit_program[tail], memory_order_acquire);
+                    if (native != NULL) {
+                        PROFILE_PUBLISH(CONCEPT_PROFILE_JIT, -1);
+                        native(locals);
+                        ConceptValue_t result = locals[0];
+                        stack->top = -1;
+                        stack_push_fast(stack, result);
+                        PROCEDURE_RETURN();
+                        NEXT();
+                    }
+                }
+                PROCEDURE_ENTER(tail);
+                i = -1;
+                NEXT();
+            }
+            TARGET(CONCEPT_LOAD):
+            TARGET(CONCEPT_FLOAD):
+                stack_push_fast(stack, locals[program[index][i].as.i]);
+                NEXT();
+            TARGET(CONCEPT_STORE):
+            TARGET(CONCEPT_FSTORE):
+                locals[program[index][i].as.i] = stack_pop_fast(stack);
+                NEXT();
+            TARGET(CONCEPT_INC):
+                concept_incr(stack);
+                NEXT();
+            TARGET(CONCEPT_DEC):
+                concept_decr(stack);
+                NEXT();
+            TARGET(CONCEPT_SWAP):
+                concept_swap(stack);
+                NEXT();
+            TARGET(CONCEPT_SCAT):
+                concept_scat(stack);
+                NEXT();
+
+            // superinstructions: the second half stays at i + 1, which is skipped unless it is jumped to
+            TARGET(CONCEPT_ICONST_LOAD):
+                stack_push_fast(stack, value_int(program[index][i].as.i));
+                stack_push_fast(stack, locals[program[index][i + 1].as.i]);
+                i++;
+                NEXT();
+            TARGET(CONCEPT_ILT_IF_ICMPLE): {
+                int32_t a = stack_pop_fast(stack).as.i;
+                int32_t b = stack_pop_fast(stack).as.i;
+                if (!(a < b)) {
+                    BACK_EDGE(program[index][i + 1].as.i);
+                    i = (program[index][i + 1].as.i) - 1;
+                } else {
+                    i++;
+                }
+                NEXT();
+            }
+            TARGET(CONCEPT_STORE_GOTO):
+                locals[program[index][i].as.i] = stack_pop_fast(stack);
+                BACK_EDGE(program[index][i + 1].as.i);
+                i = (program[index][i + 1].as.i) - 1;
+                NEXT();
+            TARGET(CONCEPT_IEQ_IF_ICMPLE): {
+                int32_t a = stack_pop_fast(stack).as.i;
+                int32_t b = stack_pop_fast(stack).as.i;
+                if (!(a == b)) {
+                    BACK_EDGE(program[index][i + 1].as.i);
+                    i = (program[index][i + 1].as.i) - 1;
+                } else {
+                    i++;
+                }
+                NEXT();
+            }
+            TARGET(CONCEPT_INC_STORE):
+                concept_incr(stack);
+                locals[program[index][i + 1].as.i] = stack_pop_fast(stack);
+                i++;
+                NEXT();
+            TARGET(CONCEPT_ICONST_SWAP): {
+                ConceptValue_t top = stack_pop_fast(stack);
+                stack_push_fast(stack, value_int(program[index][i].as.i));
+                stack_push_fast(stack, top);
+                i++;
+                NEXT();
+            }
+            TARGET(CONCEPT_LOAD_INC):
+                stack_push_fast(stack, locals[program[index][i].as.i]);
+                concept_incr(stack);
+                i++;
+                NEXT();
+            TARGET(CONCEPT_LOAD_IADD):
+                stack_push_fast(stack, locals[program[index][i].as.i]);
+                concept_iadd(stack);
+                i++;
+                NEXT();
+            TARGET(CONCEPT_DUP):
+                concept_dupl(stack);
+                NEXT();
+            TARGET(CONCEPT_IF_ICMPLE):
+                if (!stack_pop_fast(stack).as.i) {
+#ifdef DEBUG
+                    printf("\nICMPLE: Value is TRUE. \n");
+#endif
+                    BACK_EDGE(program[index][i].as.i);
+                    i = (program[index][i].as.i) - 1;
+                }
+                NEXT();
+            TARGET(CONCEPT_GOTO):
+#ifdef DEBUG
+                printf("\nGOTO warning: TRASHing this current eval() and push local stack to a new one... Returning directly afterwards!\n");
+#endif
+
+                BACK_EDGE(program[index][i].as.i);
+                i = (program[index][i].as.i) - 1;
+                NEXT();
+            TARGET(CONCEPT_HALT):
+                on_error(CONCEPT_GENERAL_ERROR, " Exit by HALT.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+                NEXT();
+            TARGET(CONCEPT_RETURN):
+#ifdef DEBUG
+                printf("\neval: RETURNing to parent function call...\n" ANSI_COLOR_RESET ANSI_COLOR_MAGENTA);
+#endif
+                PROCEDURE_RETURN();
+                NEXT();
+#ifdef THREADED_DISPATCH
+    do_unknown:
+#else
+            default:
+#endif
+                on_error(CONCEPT_COMPILER_ERROR, "Error: Unknown instruction", CONCEPT_STATE_CATASTROPHE,
+                         CONCEPT_ABORT);
+                NEXT(); // do nothing
+#ifndef THREADED_DISPATCH
+        }
+    }
+#else
+    do_end_of_procedure:
+#ifdef DEBUG
+    printf("\neval: Naturally RETURNing to parent function call...\n");
+#endif
+    PROCEDURE_RETURN();
+    NEXT();
+#endif
+}
+
+// Zeroed work memory for the loader, released all at once when the load is done or abandoned
+void *scratch_calloc(size_t count, size_t size) {
+    return memset(arena_alloc(&scratch_arena, count * size), 0, count * size);
+}
+
+/*
+ * Load-time verifier
+ * ------------------
+ * verify_procedures() interprets every procedure abstractly over its control-flow graph. The state at an
+ * instruction is the operand depth plus a type for each operand and each argument/local slot; where paths join,
+ * the depths have to agree and differing types widen to VERIFY_ANY. A program is rejected if any instruction can
+ * pop from an empty stack, sees an operand of the wrong type, or is reached with two different depths. What
+ * survives runs on the unchecked stack_*_fast() accessors.
+ */
+
+#define VERIFY_ANY 0xFF // not known statically, checked by the handlers that care
+
+// Operand types an instruction accepts, one bit per CONCEPT_VALUE_*
+#define VERIFY_MASK(type) (1u << (type))
+#define VERIFY_INTS (VERIFY_MASK(CONCEPT_VALUE_INT) | VERIFY_MASK(CONCEPT_VALUE_BOOL))
+#define VERIFY_FLOATS VERIFY_MASK(CONCEPT_VALUE_FLOAT)
+#define VERIFY_STRINGS VERIFY_MASK(CONCEPT_VALUE_STRING)
+#define VERIFY_ALL 0xFFFFFFFFu
+
+typedef struct {
+    int32_t depth; // -1 until the instruction is reached
+    uint8_t *types; // slots first, then depth operands
+} ConceptVerifyState_t;
+
+static void verify_fail(int32_t procedure, int32_t pc, const char *reason) {
+    printf("\n Verify: ERR: %s @ procedure %s, instruction %d.\n", reason, procedure_call_table[procedure], pc);
+    concept_exit(130);
+}
+
+// Pop the abstract operand, which has to be one of the accepted types
+static uint8_t verify_pop(uint8_t *types, int32_t slots, int32_t *depth, uint32_t accepts, int32_t procedure,
+                          int32_t pc) {
+    if (*depth <= 0)
+        verify_fail(procedure, pc, "Stack underflow");
+    uint8_t type = types[slots + --(*depth)];
+    if (type != VERIFY_ANY && !(accepts & VERIFY_MASK(type)))
+        verify_fail(procedure, pc, "Operand type mismatch");
+    return type;
+}
+
+typedef struct {
+    int32_t *pcs;
+    BOOL *queued;
+    int32_t pending;
+} ConceptVerifyWorklist_t;
+
+static void verify_queue(ConceptVerifyWorklist_t *worklist, int32_t pc) {
+    if (!worklist->queued[pc]) {
+        worklist->queued[pc] = TRUE;
+        worklist->pcs[worklist->pending++] = pc;
+    }
+}
+
+// Merge a successor's incoming state, queueing it when it changed
+static void verify_merge(ConceptVerifyState_t *states, ConceptVerifyWorklist_t *worklist, int32_t target,
+                         const uint8_t *types, int32_t slots, int32_t depth, int32_t procedure, int32_t pc) {
+    ConceptVerifyState_t *state = &states[target];
+    if (state->depth < 0) {
+        state->depth = depth;
+        state->types = arena_alloc(&scratch_arena, (size_t) (slots + depth) + 1);
+        memcpy(state->types, types, (size_t) (slots + depth));
+        verify_queue(worklist, target);
+        return;
+    }
+    if (state->depth != depth)
+        verify_fail(procedure, pc, "Stack depth differs where paths join");
+    BOOL changed = FALSE;
+    for (int32_t t = 0; t < slots + depth; t++) {
+        if (state->types[t] != types[t] && state->types[t] != VERIFY_ANY) {
+            state->types[t] = VERIFY_ANY;
+            changed = TRUE;
+        }
+    }
+    if (changed)
+        verify_queue(worklist, target);
+}
+
+// When depths is not NULL, it receives the operand depth at every instruction, -1 where unreachable
+int32_t verify_procedure(int32_t p, int32_t *depths) {
+    int32_t len = procedure_length_table[p];
+    int32_t slots = FRAME_SLOTS(p);
+    ConceptInstruction_t *code = program[p];
+
+    // an instruction is queued again whenever its incoming state widens; types only ever widen, so this ends
+    ConceptVerifyState_t *states = arena_alloc(&scratch_arena, sizeof(ConceptVerifyState_t) * (len + 1));
+    ConceptVerifyWorklist_t worklist = {arena_alloc(&scratch_arena, sizeof(int32_t) * (len + 1)),
+                                        scratch_calloc((size_t) len + 1, sizeof(BOOL)), 0};
+    for (int32_t i = 0; i <= len; i++)
+        states[i].depth = -1, states[i].types = NULL;
+    int32_t max_depth = 0;
+
+    uint8_t *entry = arena_alloc(&scratch_arena, (size_t) slots + 1);
+    for (int32_t k = 0; k < slots; k++)
+        entry[k] = k < procedure_args_table[p] ? VERIFY_ANY : CONCEPT_VALUE_VOID;
+    if (len > 0)
+        verify_merge(states, &worklist, 0, entry, slots, 0, p, 0);
+
+    // scratch state: one instruction pushes at most two operands
+    uint8_t *types = arena_alloc(&scratch_arena, (size_t) slots + len + 3);
+    while (worklist.pending > 0) {
+        int32_t pc = worklist.pcs[--worklist.pending];
+        worklist.queued[pc] = FALSE;
+        int32_t depth = states[pc].depth;
+        memcpy(types, states[pc].types, (size_t) (slots + depth));
+        uint8_t *operands = types + slots;
+        int32_t instr = PLAIN_OPCODE(code[pc].instr);
+        int32_t next = pc + 1, branch = -1;
+        uint8_t a, b;
+
+        switch (instr) {
+            case CONCEPT_HALT:
+            case CONCEPT_RETURN: // the return path keeps its own check
+                next = -1;
+                break;
+            case CONCEPT_IADD:
+            case CONCEPT_IDIV:
+            case CONCEPT_IMUL:
+                verify_pop(types, slots, &depth, VERIFY_INTS, p, pc);
+                verify_pop(types, slots, &depth, VERIFY_INTS, p, pc);
+                operands[depth++] = CONCEPT_VALUE_INT;
+                break;
+            case CONCEPT_FADD:
+            case CONCEPT_FDIV:
+            case CONCEPT_FMUL:
+                verify_pop(types, slots, &depth, VERIFY_FLOATS, p, pc);
+                verify_pop(types, slots, &depth, VERIFY_FLOATS, p, pc);
+                operands[depth++] = CONCEPT_VALUE_FLOAT;
+                break;
+            case CONCEPT_ILT:
+            case CONCEPT_IEQ:
+            case CONCEPT_IGT:
+            case CONCEPT_AND:
+            case CONCEPT_OR:
+            case CONCEPT_XOR:
+            case CONCEPT_IF:
+                verify_pop(types, slots, &depth, VERIFY_INTS, p, pc);
+                verify_pop(types, slots, &depth, VERIFY_INTS, p, pc);
+                operands[depth++] = CONCEPT_VALUE_BOOL;
+                break;
+            case CONCEPT_FLT:
+            case CONCEPT_FEQ:
+            case CONCEPT_FGT:
+                verify_pop(types, slots, &depth, VERIFY_FLOATS, p, pc);
+                verify_pop(types, slots, &depth, VERIFY_FLOATS, p, pc);
+                operands[depth++] = CONCEPT_VALUE_BOOL;
+                break;
+            case CONCEPT_NE:
+                verify_pop(types, slots, &depth, VERIFY_INTS, p, pc);
+                operands[depth++] = CONCEPT_VALUE_BOOL;
+                break;
+            case CONCEPT_CCONST:
+                operands[depth++] = CONCEPT_VALUE_CHAR;
+                break;
+            case CONCEPT_ICONST:
+                operands[depth++] = CONCEPT_VALUE_INT;
+                break;
+            case CONCEPT_SCONST:
+                operands[depth++] = CONCEPT_VALUE_STRING;
+                break;
+            case CONCEPT_FCONST:
+                operands[depth++] = CONCEPT_VALUE_FLOAT;
+                break;
+            case CONCEPT_BCONST:
+                operands[depth++] = CONCEPT_VALUE_BOOL;
+                break;
+            case CONCEPT_VCONST:
+            case CONCEPT_PRINT: // prints nothing on an empty stack
+                break;
+            case CONCEPT_CALL: {
+                int32_t callee = code[pc].as.i;
+                if (callee < 0 || callee >= procedure_length_table_length)
+                    verify_fail(p, pc, "Call to an unknown procedure");
+                for (int32_t arg = 0; arg < procedure_args_table[callee]; arg++)
+                    verify_pop(types, slots, &depth, VERIFY_ALL, p, pc);
+                operands[depth++] = VERIFY_ANY;
+                break;
+            }
+            case CONCEPT_TAILCALL: { // returns whatever the callee does
+                int32_t callee = code[pc].as.i;
+                if (callee < 0 || callee >= procedure_length_table_length)
+                    verify_fail(p, pc, "Call to an unknown procedure");
+                for (int32_t arg = 0; arg < procedure_args_table[callee]; arg++)
+                    verify_pop(types, slots, &depth, VERIFY_ALL, p, pc);
+                next = -1;
+                break;
+            }
+            case CONCEPT_GLOAD:
+                operands[depth++] = VERIFY_ANY;
+                break;
+            case CONCEPT_GSTORE:
+            case CONCEPT_POP:
+                verify_pop(types, slots, &depth, VERIFY_ALL, p, pc);
+                break;
+            case CONCEPT_IF_ICMPLE:
+                verify_pop(types, slots, &depth, VERIFY_INTS, p, pc);
+                branch = code[pc].as.i;
+                break;
+            case CONCEPT_GOTO:
+                branch = code[pc].as.i;
+                next = -1;
+                break;
+            case CONCEPT_INC:
+            case CONCEPT_DEC: // in place, the operand keeps its type
+                a = verify_pop(types, slots, &depth, VERIFY_INTS, p, pc);
+                operands[depth++] = a;
+                break;
+            case CONCEPT_DUP:
+                a = verify_pop(types, slots, &depth, VERIFY_ALL, p, pc);
+                operands[depth++] = a;
+                operands[depth++] = a;
+                break;
+            case CONCEPT_SWAP:
+                a = verify_pop(types, slots, &depth, VERIFY_ALL, p, pc);
+                b = verify_pop(types, slots, &depth, VERIFY_ALL, p, pc);
+                operands[depth++] = a;
+                operands[depth++] = b;
+                break;
+            case CONCEPT_LOAD:
+            case CONCEPT_FLOAD:
+                a = types[code[pc].as.i];
+                if (instr == CONCEPT_FLOAD && a != VERIFY_ANY && a != CONCEPT_VALUE_FLOAT)
+                    verify_fail(p, pc, "Operand type mismatch");
+                operands[depth++] = a;
+                break;
+            case CONCEPT_STORE:
+                types[code[pc].as.i] = verify_pop(types, slots, &depth, VERIFY_ALL, p, pc);
+                break;
+            case CONCEPT_FSTORE:
+                types[code[pc].as.i] = verify_pop(types, slots, &depth, VERIFY_FLOATS, p, pc);
+                break;
+            case CONCEPT_SCAT:
+                verify_pop(types, slots, &depth, VERIFY_STRINGS, p, pc);
+                verify_pop(types, slots, &depth, VERIFY_STRINGS, p, pc);
+                operands[depth++] = CONCEPT_VALUE_STRING;
+                break;
+            default:
+                verify_fail(p, pc, "Unknown instruction");
+        }
+        if (depth > max_depth)
+            max_depth = depth;
+
+        // falling off the end (index len) returns like ret
+        if (branch >= 0) {
+            if (branch > len)
+                verify_fail(p, pc, "Jump target out of procedure");
+            if (branch < len)
+                verify_merge(states, &worklist, branch, types, slots, depth, p, pc);
+        }
+        if (next >= 0 && next < len)
+            verify_merge(states, &worklist, next, types, slots, depth, p, pc);
+    }
+
+    if (depths != NULL)
+        for (int32_t i = 0; i < len; i++)
+            depths[i] = states[i].depth;
+    return max_depth;
+}
+
+// Verify every procedure and record its maximum operand depth
+void verify_procedures() {
+    procedure_max_depth_table = arena_alloc(&program_arena, sizeof(int32_t) * procedure_length_table_length);
+    for (int32_t p = 0; p < procedure_length_table_length; p++) {
+        procedure_max_depth_table[p] = verify_procedure(p, NULL);
+#ifdef DEBUG
+        printf("\nVerify: procedure %s, max depth %d\n", procedure_call_table[p], procedure_max_depth_table[p]);
+#endif
+    }
+}
+
+/*
+ * Inliner
+ * -------
+ * inline_procedures() splices small leaf procedures into their callers right after parsing. At a call site the
+ * arguments are stored into slots appended to the caller's locals, the callee's body follows with its slots
+ * shifted there, and its returns become jumps past the body. A callee qualifies if it makes no calls, has at most
+ * CONCEPT_INLINE_BUDGET instructions, leaves exactly its return value on the stack wherever it returns, only
+ * prints with operands of its own on the stack, and stores every local before loading it without any jumps in
+ * between, since nothing resets the slots to void.
+ * Each caller grows by at most CONCEPT_INLINE_GROWTH instructions; calls past that stay calls.
+ */
+
+#ifndef CONCEPT_INLINE_BUDGET
+#define CONCEPT_INLINE_BUDGET 12
+#endif
+#ifndef CONCEPT_INLINE_GROWTH
+#define CONCEPT_INLINE_GROWTH 256
+#endif
+
+static BOOL inline_candidate(int32_t c) {
+    int32_t len = procedure_length_table[c];
+    ConceptInstruction_t *code = program[c];
+    if (len == 0 || len > CONCEPT_INLINE_BUDGET)
+        return 0;
+    BOOL jumps = 0;
+    BOOL *stored = scratch_calloc((size_t) FRAME_SLOTS(c) + 1, sizeof(BOOL));
+    BOOL ok = 1;
+    for (int32_t i = 0; i < len && ok; i++) {
+        int32_t instr = code[i].instr;
+        if (instr == CONCEPT_CALL || instr == CONCEPT_TAILCALL || concept_opcodes[instr].mnemonic == NULL)
+            ok = 0;
+        else if (instr == CONCEPT_GOTO || instr == CONCEPT_IF_ICMPLE)
+            jumps = 1;
+        else if ((instr == CONCEPT_STORE || instr == CONCEPT_FSTORE) && !jumps)
+            stored[code[i].as.i] = 1;
+        else if ((instr == CONCEPT_LOAD || instr == CONCEPT_FLOAD)
+                 && code[i].as.i >= procedure_args_table[c] && !stored[code[i].as.i])
+            ok = 0;
+    }
+    if (!ok)
+        return 0;
+
+    // every way out has to leave the return value alone on the stack
+    int32_t *depths = arena_alloc(&scratch_arena, sizeof(int32_t) * (len + 1));
+    verify_procedure(c, depths);
+    for (int32_t i = 0; i < len && ok; i++) {
+        int32_t instr = code[i].instr;
+        if (depths[i] < 0)
+            continue;
+        if (instr == CONCEPT_PRINT) // on an empty stack it prints nothing, inlined it would print the caller's top
+            ok = depths[i] > 0;
+        else if (instr == CONCEPT_RETURN || (instr == CONCEPT_GOTO && code[i].as.i == len))
+            ok = depths[i] == 1;
+        else if (instr == CONCEPT_IF_ICMPLE && code[i].as.i == len)
+            ok = depths[i] - 1 == 1;
+    }
+    int32_t last = code[len - 1].instr;
+    if (ok && depths[len - 1] >= 0 && last != CONCEPT_RETURN && last != CONCEPT_GOTO && last != CONCEPT_HALT)
+        ok = depths[len - 1] - concept_opcodes[last].pops + concept_opcodes[last].pushes == 1;
+    return ok;
+}
+
+// Rewrite caller p with the qualifying calls expanded, returning whether anything was inlined
+static BOOL inline_calls(int32_t p, const BOOL *candidates) {
+    int32_t len = procedure_length_table[p];
+    ConceptInstruction_t *code = program[p];
+    int32_t base = FRAME_SLOTS(p); // the callees' slots, shared as inlined bodies never overlap
+    int32_t extra = 0;
+    BOOL inlined = 0;
+
+    // where every instruction lands, and which calls are expanded
+    int32_t *map = arena_alloc(&scratch_arena, sizeof(int32_t) * (len + 1));
+    BOOL *expand = scratch_calloc((size_t) len + 1, sizeof(BOOL));
+    int32_t new_len = 0;
+    for (int32_t i = 0; i < len; i++) {
+        map[i] = new_len;
+        int32_t c = code[i].instr == CONCEPT_CALL ? code[i].as.i : -1;
+        int32_t size = c >= 0 ? procedure_args_table[c] + procedure_length_table[c] : 0;
+        if (c >= 0 && c != p && candidates[c] && new_len + size - (i + 1) <= CONCEPT_INLINE_GROWTH) {
+            expand[i] = 1;
+            inlined = 1;
+            new_len += size;
+            if (FRAME_SLOTS(c) > extra)
+                extra = FRAME_SLOTS(c);
+        } else {
+            new_len++;
+        }
+    }
+    map[len] = new_len;
+    if (!inlined)
+        return 0;
+
+    ConceptInstruction_t *out = arena_alloc(&program_arena, sizeof(ConceptInstruction_t) * (new_len + 1));
+    int32_t n = 0;
+    for (int32_t i = 0; i < len; i++) {
+        int32_t instr = code[i].instr;
+        if (!expand[i]) {
+            out[n] = code[i];
+            if (instr == CONCEPT_GOTO || instr == CONCEPT_IF_ICMPLE)
+                out[n].as.i = map[code[i].as.i];
+            n++;
+            continue;
+        }
+        int32_t c = code[i].as.i;
+        ConceptInstruction_t *body = program[c];
+        int32_t body_len = procedure_length_table[c];
+        // arguments come off the stack last one first
+        for (int32_t arg = procedure_args_table[c] - 1; arg >= 0; arg--)
+            out[n++] = (ConceptInstruction_t) {CONCEPT_STORE, 0, {.i = base + arg}};
+        int32_t start = n, end = map[i + 1];
+        for (int32_t k = 0; k < body_len; k++, n++) {
+            int32_t op = body[k].instr;
+            out[n] = body[k];
+            if (op == CONCEPT_LOAD || op == CONCEPT_FLOAD || op == CONCEPT_STORE || op == CONCEPT_FSTORE) {
+                out[n].as.i = base + body[k].as.i;
+            } else if (op == CONCEPT_GOTO || op == CONCEPT_IF_ICMPLE) {
+                int32_t target = body[k].as.i;
+                out[n].as.i = target < body_len ? start + target : end;
+            } else if (op == CONCEPT_RETURN) {
+                out[n] = (ConceptInstruction_t) {CONCEPT_GOTO, 0, {.i = end}};
+            }
+        }
+    }
+#ifdef DEBUG
+    printf("\nInline: procedure %s, %d -> %d instructions, %d more slots\n", procedure_call_table[p], len, new_len,
+           extra);
+#endif
+    program[p] = out;
+    procedure_length_table[p] = new_len;
+    procedure_locals_table[p] += extra;
+    return 1;
+}
+
+// Inline small leaf procedures into their callers
+void inline_procedures() {
+    BOOL *candidates = arena_alloc(&scratch_arena, sizeof(BOOL) * (procedure_length_table_length + 1));
+    for (int32_t c = 0; c < procedure_length_table_length; c++)
+        candidates[c] = inline_candidate(c);
+    // callers of candidates are no candidates themselves, so every body spliced is an original one
+    for (int32_t p = 0; p < procedure_length_table_length; p++)
+        inline_calls(p, candidates);
+}
+
+// A call directly followed by ret becomes a tail call, which reuses the caller's frame: tail recursion runs in
+// constant space. The ret stays in place for jumps to it.
+void mark_tail_calls() {
+    for (int32_t p = 0; p < procedure_length_table_length; p++) {
+        ConceptInstruction_t *code = program[p];
+        for (int32_t i = 0; i + 1 < procedure_length_table[p]; i++)
+            if (code[i].instr == CONCEPT_CALL && code[i + 1].instr == CONCEPT_RETURN)
+                code[i].instr = CONCEPT_TAILCALL;
+    }
+}
+
+/*
+ * Optimizer
+ * ---------
+ * optimize_procedures() runs right after inlining, which is what exposes most constants. Constant folding
+ * evaluates straight-line runs of constants through the opcode handlers at load time, so `iconst 10; iconst 20;
+ * iadd` becomes `iconst 30`, and a branch on a constant becomes a goto or disappears. Nothing is folded across a
+ * jump target, and an operation that would abort at run time or that the verifier would reject is left in place,
+ * so errors still surface where they did. Dead-code elimination then drops whatever no path from the entry
+ * reaches, along with jumps to the very next instruction, and compacts the procedure with its jumps retargeted.
+ */
+
+// The value pushed by a constant instruction; strings are never folded
+static BOOL optimize_constant(const ConceptInstruction_t *in, ConceptValue_t *value) {
+    switch (in->instr) {
+        case CONCEPT_ICONST:
+            *value = value_int(in->as.i);
+            return 1;
+        case CONCEPT_BCONST:
+            *value = value_bool(in->as.i);
+            return 1;
+        case CONCEPT_FCONST:
+            *value = value_float(in->as.f);
+            return 1;
+        case CONCEPT_CCONST:
+            *value = value_char(in->as.c);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// The constant instruction pushing value
+static ConceptInstruction_t optimize_emit(ConceptValue_t value) {
+    switch (value.type) {
+        case CONCEPT_VALUE_FLOAT:
+            return (ConceptInstruction_t) {CONCEPT_FCONST, 0, {.f = value.as.f}};
+        case CONCEPT_VALUE_CHAR:
+            return (ConceptInstruction_t) {CONCEPT_CCONST, 0, {.c = value.as.c}};
+        case CONCEPT_VALUE_BOOL:
+            return (ConceptInstruction_t) {CONCEPT_BCONST, 0, {.i = value.as.i}};
+        default:
+            return (ConceptInstruction_t) {CONCEPT_ICONST, 0, {.i = value.as.i}};
+    }
+}
+
+// Run instr's handler over constant operands (top last, room for one more), returning how many values it leaves
+// there, or -1 if it must stay a run time operation
+static int32_t optimize_evaluate(int32_t instr, ConceptValue_t *operands, int32_t count) {
+    const ConceptOpcode_t *opcode = &concept_opcodes[instr];
+    uint32_t accepts;
+    switch (instr) {
+        case CONCEPT_IADD:
+        case CONCEPT_IDIV:
+        case CONCEPT_IMUL:
+        case CONCEPT_ILT:
+        case CONCEPT_IEQ:
+        case CONCEPT_IGT:
+        case CONCEPT_AND:
+        case CONCEPT_OR:
+        case CONCEPT_XOR:
+        case CONCEPT_NE:
+        case CONCEPT_IF:
+            accepts = VERIFY_INTS;
+            break;
+        case CONCEPT_INC:
+        case CONCEPT_DEC: // a bool would stay a bool, but no longer 0 or 1
+            accepts = VERIFY_MASK(CONCEPT_VALUE_INT);
+            break;
+        case CONCEPT_FADD:
+        case CONCEPT_FDIV:
+        case CONCEPT_FMUL:
+        case CONCEPT_FLT:
+        case CONCEPT_FEQ:
+        case CONCEPT_FGT:
+            accepts = VERIFY_FLOATS;
+            break;
+        case CONCEPT_DUP:
+        case CONCEPT_SWAP:
+            accepts = VERIFY_ALL;
+            break;
+        default:
+            return -1;
+    }
+    if (opcode->pops != count)
+        return -1;
+    for (int32_t k = 0; k < count; k++)
+        if (!(accepts & VERIFY_MASK(operands[k].type)))
+            return -1;
+
+    // whatever would abort at run time is left to do so
+    ConceptValue_t *a = &operands[count - 1], *b = &operands[0];
+    float f;
+    switch (instr) {
+        case CONCEPT_IADD:
+            if ((int64_t) a->as.i + b->as.i > INT32_MAX || (int64_t) a->as.i + b->as.i < INT32_MIN)
+                return -1;
+            break;
+        case CONCEPT_IMUL:
+            if ((int64_t) a->as.i * b->as.i > INT32_MAX || (int64_t) a->as.i * b->as.i < INT32_MIN)
+                return -1;
+            break;
+        case CONCEPT_IDIV:
+            if (b->as.i == 0 || (a->as.i == INT32_MIN && b->as.i == -1))
+                return -1;
+            break;
+        case CONCEPT_FADD:
+        case CONCEPT_FDIV:
+        case CONCEPT_FMUL:
+            f = instr == CONCEPT_FADD ? a->as.f + b->as.f : instr == CONCEPT_FDIV ? a->as.f / b->as.f : a->as.f * b->as.f;
+            if (!(f <= FLT_MAX && f >= -FLT_MAX))
+                return -1;
+            break;
+        case CONCEPT_INC:
+            if (a->as.i == INT32_MAX)
+                return -1;
+            break;
+        case CONCEPT_DEC:
+            if (a->as.i == INT32_MIN)
+                return -1;
+            break;
+        default:
+            break;
+    }
+
+    ConceptStack_t scratch = {count - 1, count + 1, operands};
+    opcode->handler(&scratch);
+    return scratch.top + 1;
+}
+
+// Fold the constant operations of procedure p, returning whether anything changed
+static BOOL fold_constants(int32_t p) {
+    int32_t len = procedure_length_table[p];
+    ConceptInstruction_t *code = program[p];
+
+    // a jump target starts a new run, since the stack there also comes from elsewhere
+    BOOL *labels = scratch_calloc((size_t) len + 1, sizeof(BOOL));
+    for (int32_t i = 0; i < len; i++) {
+        if (code[i].instr == CONCEPT_GOTO || code[i].instr == CONCEPT_IF_ICMPLE) {
+            int32_t target = code[i].as.i;
+            if (target < 0 || target > len) // left for the verifier to report
+                return 0;
+            labels[target] = 1;
+        }
+    }
+
+    ConceptInstruction_t *out = arena_alloc(&scratch_arena, sizeof(ConceptInstruction_t) * (len + 1));
+    int32_t *map = arena_alloc(&scratch_arena, sizeof(int32_t) * (len + 1));
+    int32_t n = 0, run = 0;
+    BOOL folded = 0;
+    for (int32_t i = 0; i < len; i++) {
+        if (labels[i])
+            run = n;
+        map[i] = n;
+        int32_t instr = code[i].instr;
+
+        // up to two constants on top of the stack, pushed within the current run
+        ConceptValue_t operands[3];
+        int32_t count = 0;
+        if (n - 1 >= run && optimize_constant(&out[n - 1], &operands[1])) {
+            count = 1;
+            if (n - 2 >= run && optimize_constant(&out[n - 2], &operands[0]))
+                count = 2;
+        }
+
+        if (instr == CONCEPT_POP && count > 0) {
+            n--;
+            folded = 1;
+            continue;
+        }
+        if (instr == CONCEPT_IF_ICMPLE && count > 0 && (VERIFY_INTS & VERIFY_MASK(operands[1].type))) {
+            n--;
+            if (!operands[1].as.i) // jumps when false
+                out[n++] = (ConceptInstruction_t) {CONCEPT_GOTO, 0, {.i = code[i].as.i}};
+            folded = 1;
+            continue;
+        }
+        int32_t pops = concept_opcodes[instr].pops;
+        if (pops > 0 && count >= pops) {
+            ConceptValue_t *values = operands + 2 - pops;
+            int32_t results = optimize_evaluate(instr, values, pops);
+            if (results >= 0) {
+                n -= pops;
+                for (int32_t k = 0; k < results; k++)
+                    out[n++] = optimize_emit(values[k]);
+                folded = 1;
+                continue;
+            }
+        }
+        out[n++] = code[i];
+    }
+    map[len] = n;
+
+    if (folded) {
+        program[p] = arena_alloc(&program_arena, sizeof(ConceptInstruction_t) * (n + 1));
+        for (int32_t k = 0; k < n; k++) {
+            program[p][k] = out[k];
+            if (out[k].instr == CONCEPT_GOTO || out[k].instr == CONCEPT_IF_ICMPLE)
+                program[p][k].as.i = map[out[k].as.i];
+        }
+        procedure_length_table[p] = n;
+    }
+    return folded;
+}
+
+// Drop the instructions of procedure p that are never reached, returning whether anything changed
+static BOOL eliminate_dead_code(int32_t p) {
+    int32_t len = procedure_length_table[p];
+    ConceptInstruction_t *code = program[p];
+    if (len == 0)
+        return 0;
+
+    BOOL *live = scratch_calloc((size_t) len + 1, sizeof(BOOL));
+    int32_t *pending = arena_alloc(&scratch_arena, sizeof(int32_t) * (len + 1));
+    int32_t count = 0;
+    live[0] = 1;
+    pending[count++] = 0;
+    while (count > 0) {
+        int32_t pc = pending[--count];
+        int32_t instr = code[pc].instr;
+        int32_t successors[2], found = 0;
+        if (instr != CONCEPT_GOTO && instr != CONCEPT_RETURN && instr != CONCEPT_HALT && instr != CONCEPT_TAILCALL)
+            successors[found++] = pc + 1;
+        if (instr == CONCEPT_GOTO || instr == CONCEPT_IF_ICMPLE) {
+            successors[found] = code[pc].as.i;
+            if (successors[found] < 0 || successors[found] > len) // left for the verifier to report
+                return 0;
+            found++;
+        }
+        for (int32_t k = 0; k < found; k++) {
+            if (successors[k] < len && !live[successors[k]]) {
+                live[successors[k]] = 1;
+                pending[count++] = successors[k];
+            }
+        }
+    }
+    // a jump to the next instruction goes too; jumps to it land on that one instead
+    for (int32_t i = 0; i < len; i++)
+        if (live[i] && code[i].instr == CONCEPT_GOTO && code[i].as.i == i + 1)
+            live[i] = 0;
+
+    int32_t *map = pending; // done with the worklist
+    int32_t n = 0;
+    for (int32_t i = 0; i < len; i++) {
+        map[i] = n;
+        if (live[i])
+            n++;
+    }
+    map[len] = n;
+
+    if (n < len) {
+        ConceptInstruction_t *out = arena_alloc(&program_arena, sizeof(ConceptInstruction_t) * (n + 1));
+        for (int32_t i = 0; i < len; i++) {
+            if (!live[i])
+                continue;
+            out[map[i]] = code[i];
+            if (code[i].instr == CONCEPT_GOTO || code[i].instr == CONCEPT_IF_ICMPLE)
+                out[map[i]].as.i = map[code[i].as.i];
+        }
+        program[p] = out;
+        procedure_length_table[p] = n;
+    }
+    return n < len;
+}
+
+// Fold constants and remove dead code until neither finds anything more. Each procedure is verified first, so a
+// program the verifier rejects is never made acceptable by folding away the offending path.
+void optimize_procedures() {
+    for (int32_t p = 0; p < procedure_length_table_length; p++) {
+#ifdef DEBUG
+        int32_t len = procedure_length_table[p];
+#endif
+        verify_procedure(p, NULL);
+        while (fold_constants(p) | eliminate_dead_code(p));
+#ifdef DEBUG
+        printf("\nOptimize: procedure %s, %d -> %d instructions\n", procedure_call_table[p], len,
+               procedure_length_table[p]);
+#endif
+    }
+}
+
+// Superinstruction patterns, see the end of opcodes.def
+static const struct {
+    int32_t first, second, fused;
+} concept_superinstructions[] = {
+#define CONCEPT_OPCODE(name, mnemonic, code, payload, pops, pushes, handler)
+#define CONCEPT_SUPER(name, mnemonic, code, payload, pops, pushes, first, second) \
+        {CONCEPT_##first, CONCEPT_##second, code},
+#include "opcodes.def"
+};
+
+// Rewrite frequent instruction pairs into superinstructions, left to right without overlap.
+// Only the opcode of the first instruction changes, so indices and jump targets stay valid.
+void fuse_superinstructions() {
+    size_t patterns = sizeof(concept_superinstructions) / sizeof(concept_superinstructions[0]);
+    for (int32_t p = 0; p < procedure_length_table_length; p++) {
+        ConceptInstruction_t *code = program[p];
+        for (int32_t i = 0; i + 1 < procedure_length_table[p]; i++) {
+            for (size_t k = 0; k < patterns; k++) {
+                if (code[i].instr == concept_superinstructions[k].first
+                    && code[i + 1].instr == concept_superinstructions[k].second) {
+                    code[i].instr = concept_superinstructions[k].fused;
+                    i++;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+#ifdef THREADED_DISPATCH
+// Translate every parsed procedure into an array of handler addresses, plus a trailing end-of-procedure handler
+// so that falling off the last instruction returns like the switch loop does.
+void thread_procedures() {
+    if (dispatch_labels == NULL)
+        eval(-1, NULL, NULL, NULL, 0);
+
+    threaded_program = (void ***) arena_alloc(&program_arena, sizeof(void **) * procedure_length_table_length);
+    for (int32_t p = 0; p < procedure_length_table_length; p++) {
+        void **handlers = (void **) arena_alloc(&program_arena, sizeof(void *) * (procedure_length_table[p] + 1));
+        for (int32_t i = 0; i < procedure_length_table[p]; i++) {
+            int32_t instr = program[p][i].instr;
+            handlers[i] = (instr >= 0 && instr < CONCEPT_OPCODE_MAX) ? dispatch_labels[instr] : dispatch_label_unknown;
+
+            // a jump may land on the end marker, but never past it
+            if (instr == CONCEPT_GOTO || instr == CONCEPT_IF_ICMPLE) {
+                int32_t target = program[p][i].as.i;
+                if (target < 0 || target > procedure_length_table[p])
+                    on_error(CONCEPT_COMPILER_ERROR, "Jump target out of procedure.", CONCEPT_STATE_ERROR,
+                             CONCEPT_WARN_EXITNOW);
+            }
+        }
+        handlers[procedure_length_table[p]] = dispatch_label_end;
+        threaded_program[p] = handlers;
+    }
+}
+#endif
+
+char *substring(char *string, int32_t start, int32_t end) {
+    char *subbuff = arena_alloc(&program_arena, sizeof(char) * (end - start + 1));
+    memcpy(subbuff, &string[start], (end - start));
+    subbuff[end - start] = '\0';
+    return subbuff;
+}
+
+// Map the source file; lines are handed out as views into the mapping by next_line()
+void read_prog(char *file_path) {
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error opening file.\n");
+        concept_exit(2);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        fprintf(stderr, "Error opening file.\n");
+        concept_exit(2);
+    }
+
+    concept_program.code = NULL;
+    concept_program.len = (size_t) st.st_size;
+    if (concept_program.len > 0) { // an empty file can not be mapped
+        concept_program.code = mmap(NULL, concept_program.len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (concept_program.code == MAP_FAILED) {
+            fprintf(stderr, "err read_file(): Could not map file.\n");
+            concept_exit(3);
+        }
+        posix_madvise(concept_program.code, concept_program.len, POSIX_MADV_SEQUENTIAL); // parsed front to back, once
+    }
+    close(fd);
+}
+
+// The source is not needed anymore once it is parsed, every payload keeps its own copy
+void unmap_prog() {
+    if (concept_program.code != NULL)
+        munmap(concept_program.code, concept_program.len);
+    concept_program.code = NULL;
+    concept_program.len = 0;
+}
+
+// Hand out the next line of the source without its line terminator, FALSE at the end of the source
+static BOOL next_line(const char **cursor, ConceptView_t *line) {
+    const char *end = concept_program.code + concept_program.len;
+    if (*cursor >= end)
+        return FALSE;
+
+    const char *eol = memchr(*cursor, '\n', (size_t) (end - *cursor));
+    if (eol == NULL)
+        eol = end;
+    line->start = *cursor;
+    line->len = (int32_t) (eol - *cursor);
+    if (line->len > 0 && line->start[line->len - 1] == '\r')
+        line->len--;
+    *cursor = (eol < end) ? eol + 1 : end;
+    return TRUE;
+}
+
+// Copy a short token into buf so it can be handed to atoi()/atof()
+static char *view_to_buffer(const char *start, int32_t len, char *buf, int32_t size) {
+    if (len > size - 1)
+        len = size - 1;
+    memcpy(buf, start, (size_t) len);
+    buf[len] = '\0';
+    return buf;
+}
+// 1
+
+/*
+ * Symbol table
+ * ------------
+ * Open addressing hash table mapping names to indices, used for procedures and for the labels of the procedure
+ * being assembled.
+ */
+
+typedef struct {
+    char *name; // NULL for empty slots
+    int32_t value;
+} ConceptSymbol_t;
+
+typedef struct {
+    ConceptSymbol_t *slots;
+    int32_t capacity; // power of two
+    int32_t count;
+} ConceptSymbolTable_t;
+
+static uint32_t symbol_hash(const char *name, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char) name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void symtab_init(ConceptSymbolTable_t *table, int32_t capacity) {
+    table->slots = scratch_calloc((size_t) capacity, sizeof(ConceptSymbol_t));
+    table->capacity = capacity;
+    table->count = 0;
+}
+
+static void symtab_clear(ConceptSymbolTable_t *table) {
+    if (table->count)
+        memset(table->slots, 0, sizeof(ConceptSymbol_t) * table->capacity);
+    table->count = 0;
+}
+
+// Slot holding name, or the empty slot where it belongs
+static ConceptSymbol_t *symtab_slot(ConceptSymbolTable_t *table, const char *name, size_t len) {
+    uint32_t mask = (uint32_t) table->capacity - 1;
+    for (uint32_t h = symbol_hash(name, len) & mask;; h = (h + 1) & mask) {
+        ConceptSymbol_t *slot = &table->slots[h];
+        if (slot->name == NULL || (!strncmp(slot->name, name, len) && slot->name[len] == '\0'))
+            return slot;
+    }
+}
+
+static ConceptSymbol_t *symtab_find(ConceptSymbolTable_t *table, const char *name, size_t len) {
+    ConceptSymbol_t *slot = symtab_slot(table, name, len);
+    return slot->name ? slot : NULL;
+}
+
+// Define name; FALSE if it was already defined
+static BOOL symtab_define(ConceptSymbolTable_t *table, const char *name, size_t len, int32_t value) {
+    if ((table->count + 1) * 2 > table->capacity) { // keep the load factor under 1/2
+        ConceptSymbol_t *old = table->slots;
+        int32_t old_capacity = table->capacity;
+        symtab_init(table, old_capacity * 2);
+        for (int32_t i = 0; i < old_capacity; i++)
+            if (old[i].name != NULL) {
+                *symtab_slot(table, old[i].name, strlen(old[i].name)) = old[i];
+                table->count++;
+            }
+    }
+
+    ConceptSymbol_t *slot = symtab_slot(table, name, len);
+    if (slot->name != NULL)
+        return FALSE;
+    slot->name = substring((char *) name, 0, (int32_t) len);
+    slot->value = value;
+    table->count++;
+    return TRUE;
+}
+
+// An operand waiting for a symbol that has not been defined yet. It is addressed by position, as the procedure
+// being assembled still moves while it grows.
+typedef struct {
+    char *name;
+    int32_t procedure;
+    int32_t index;
+} ConceptFixup_t;
+
+typedef struct {
+    ConceptFixup_t *fixups;
+    int32_t len;
+    int32_t cap;
+} ConceptFixupList_t;
+
+static void fixup_add(ConceptFixupList_t *list, char *name, int32_t procedure, int32_t index) {
+    if (list->len >= list->cap) {
+        int32_t cap = list->cap ? list->cap * 2 : 16;
+        list->fixups = arena_grow(&scratch_arena, list->fixups, sizeof(ConceptFixup_t) * list->cap,
+                                  sizeof(ConceptFixup_t) * cap);
+        list->cap = cap;
+    }
+    list->fixups[list->len].name = name;
+    list->fixups[list->len].procedure = procedure;
+    list->fixups[list->len].index = index;
+    list->len++;
+}
+
+// Back-patch every pending reference, FALSE if one of them is still undefined
+static BOOL fixup_resolve(ConceptFixupList_t *list, ConceptSymbolTable_t *table) {
+    for (int32_t f = 0; f < list->len; f++) {
+        ConceptSymbol_t *symbol = symtab_find(table, list->fixups[f].name, strlen(list->fixups[f].name));
+        if (symbol == NULL) {
+            printf("\n Parse: ERR: Undefined symbol %s.", list->fixups[f].name);
+            return FALSE;
+        }
+        program[list->fixups[f].procedure][list->fixups[f].index].as.i = symbol->value;
+    }
+    list->len = 0;
+    return TRUE;
+}
+
+// Append a string constant to string_pool, returning its offset
+static uint32_t string_pool_add(const char *s, int32_t len, uint32_t *capacity) {
+    if (string_pool_size + (uint32_t) len + 1 > *capacity) {
+        uint32_t grown = (string_pool_size + (uint32_t) len + 1) * 2;
+        string_pool = arena_grow(&program_arena, string_pool, *capacity, grown);
+        *capacity = grown;
+    }
+    uint32_t offset = string_pool_size;
+    memcpy(string_pool + offset, s, (size_t) len);
+    string_pool[offset + len] = '\0';
+    string_pool_size += (uint32_t) len + 1;
+    return offset;
+}
+
+// Parse the parameter of an instruction into its operand according to the opcode's payload kind
+static void parse_operand(const ConceptOpcode_t *opcode, const char *param, int32_t len, ConceptInstruction_t *in,
+                          uint32_t *strings_capacity) {
+    char buf[64];
+    switch (opcode->payload) {
+        case CONCEPT_PAYLOAD_CHAR:
+            in->as.c = param[0];
+            break;
+        case CONCEPT_PAYLOAD_INT:
+        case CONCEPT_PAYLOAD_TARGET:
+        case CONCEPT_PAYLOAD_PROCEDURE:
+        case CONCEPT_PAYLOAD_LOCAL:
+        case CONCEPT_PAYLOAD_GLOBAL:
+            // symbolic targets, procedures and globals are filled in once they are resolved
+            in->as.i = atoi(view_to_buffer(param, len, buf, sizeof(buf)));
+            break;
+        case CONCEPT_PAYLOAD_FLOAT:
+            in->as.f = (float) atof(view_to_buffer(param, len, buf, sizeof(buf)));
+            break;
+        case CONCEPT_PAYLOAD_BOOL:
+            in->as.i = atoi(view_to_buffer(param, len, buf, sizeof(buf)));
+            if (in->as.i != 0 && in->as.i != 1) {
+                on_error(CONCEPT_COMPILER_ERROR, "BOOL value is NOT bool.", CONCEPT_STATE_ERROR,
+                         CONCEPT_WARN_EXITNOW);
+            }
+            break;
+        case CONCEPT_PAYLOAD_STRING:
+            in->as.s = string_pool_add(param, len, strings_capacity);
+            break;
+        default:
+            break;
+    }
+}
+
+// TRUE if a jump parameter is a literal instruction index rather than a label
+static BOOL is_numeric_target(const char *param, int32_t len) {
+    return (len > 0 && (isdigit((unsigned char) param[0])
+                        || (len > 1 && param[0] == '-' && isdigit((unsigned char) param[1]))));
+}
+
+// Parse the "<name>: args=N, locals=M" parameter of a ".def" line. Both counts are optional and default to 0.
+// Returns the length of the name, or -1 if the header is malformed.
+static int32_t parse_procedure_header(const char *param, int32_t len, int32_t *args, int32_t *locals) {
+    char buf[64];
+    *args = 0;
+    *locals = 0;
+    const char *colon = memchr(param, ':', (size_t) len);
+    int32_t name_len = colon ? (int32_t) (colon - param) : len;
+    while (name_len > 0 && isspace((unsigned char) param[name_len - 1])) name_len--;
+    if (name_len == 0)
+        return -1;
+
+    const char *cursor = colon ? colon + 1 : param + len;
+    const char *end = param + len;
+    while (cursor < end) {
+        const char *comma = memchr(cursor, ',', (size_t) (end - cursor));
+        const char *item_end = comma ? comma : end;
+        while (cursor < item_end && isspace((unsigned char) *cursor)) cursor++;
+        const char *eq = memchr(cursor, '=', (size_t) (item_end - cursor));
+        if (eq == NULL)
+            return -1;
+        int32_t value = atoi(view_to_buffer(eq + 1, (int32_t) (item_end - eq - 1), buf, sizeof(buf)));
+        if (value < 0)
+            return -1;
+        if (eq - cursor == 4 && !strncmp(cursor, "args", 4))
+            *args = value;
+        else if (eq - cursor == 6 && !strncmp(cursor, "locals", 6))
+            *locals = value;
+        else
+            return -1;
+        cursor = comma ? comma + 1 : end;
+    }
+    return name_len;
+}
+
+// Finish the procedure being assembled: resolve its labels and check its jumps and slot indices
+static void end_procedure(ConceptInstruction_t *procedure, int32_t len, int32_t procedure_counter,
+                          ConceptSymbolTable_t *labels, ConceptFixupList_t *label_fixups) {
+    program[procedure_counter] = procedure;
+    procedure_length_table[procedure_counter] = len;
+    if (!fixup_resolve(label_fixups, labels)) {
+        printf(" Procedure [%d].\n", procedure_counter);
+        concept_exit(130);
+    }
+    for (int32_t i = 0; i < len; i++) {
+        int32_t payload = concept_opcodes[procedure[i].instr].payload;
+        if (payload == CONCEPT_PAYLOAD_TARGET) {
+            int32_t target = procedure[i].as.i;
+            if (target < 0 || target > len)
+                on_error(CONCEPT_COMPILER_ERROR, "Jump target out of procedure.", CONCEPT_STATE_ERROR,
+                         CONCEPT_WARN_EXITNOW);
+        } else if (payload == CONCEPT_PAYLOAD_LOCAL) {
+            int32_t slot = procedure[i].as.i;
+            if (slot < 0 || slot >= FRAME_SLOTS(procedure_counter))
+                on_error(CONCEPT_COMPILER_ERROR, "Local slot out of procedure frame.", CONCEPT_STATE_ERROR,
+                         CONCEPT_WARN_EXITNOW);
+        }
+    }
+    symtab_clear(labels);
+}
+
+// Allocate the global table for one run, every global starting out void
+static void alloc_globals() {
+    global_table = (ConceptValue_t *) arena_alloc(&run_arena, sizeof(ConceptValue_t) * global_table_length);
+    for (int32_t g = 0; g < global_table_length; g++)
+        global_table[g] = value_void(NULL);
+}
+
+// parse_procedures() assembles the source in one single pass.
+// A "procedure <name>" or ".def <name>: args=N, locals=M" line opens a new procedure, which runs until the next one
+// or the end of the file. Its arguments and locals are frame slots 0..N+M-1, reached through load/store.
+// Every other line is either a "<label>:" definition or an instruction, parsed into the procedure's bytecode array.
+// Procedure names and labels live in hashed symbol tables. A call or jump to a name that is not defined yet
+// records a fixup, back-patched once the label's procedure ends (labels) or once the file ends (procedures),
+// so calls end up holding the ACTUAL index of the bytecode procedure and lookups stay O(1).
+// Global names are program-wide and numbered densely in order of first use, so gload/gstore index the table directly.
+void parse_procedures() {
+
+#ifdef DEBUG
+    printf(ANSI_COLOR_CYAN "\nConceptual-FANNGGOVITCH Bytecode Parser. Parsing input...\n");
+#endif
+    int32_t procedures_allocated = 16;
+    procedure_call_table = (char **) arena_alloc(&program_arena, sizeof(char *) * procedures_allocated);
+    procedure_length_table = (int32_t *) arena_alloc(&program_arena, sizeof(int32_t) * procedures_allocated);
+    procedure_args_table = (int32_t *) arena_alloc(&program_arena, sizeof(int32_t) * procedures_allocated);
+    procedure_locals_table = (int32_t *) arena_alloc(&program_arena, sizeof(int32_t) * procedures_allocated);
+    program = (ConceptInstruction_t **) arena_alloc(&program_arena, sizeof(ConceptInstruction_t *) * procedures_allocated);
+
+    ConceptSymbolTable_t procedures, labels, globals;
+    symtab_init(&procedures, 64);
+    symtab_init(&labels, 64);
+    symtab_init(&globals, 64);
+    ConceptFixupList_t call_fixups = {NULL, 0, 0};
+    ConceptFixupList_t label_fixups = {NULL, 0, 0};
+
+    int32_t procedure_counter = -1; // none open yet
+    ConceptInstruction_t *procedure = NULL;
+    int32_t counter = 0; // fur PSA
+    int32_t capacity = 0;
+    uint32_t strings_capacity = 0;
+    string_pool = NULL;
+    string_pool_size = 0;
+
+#ifdef DEBUG
+    printf("\nFANNGGOVITCH Bytecode Lexer: START\n");
+#endif
+
+    const char *cursor = concept_program.code;
+    ConceptView_t line;
+    for (int32_t d = 0; next_line(&cursor, &line); d++) {
+        // parse, parse, parse!
+        const char *s_line = line.start;
+        int32_t line_len = line.len;
+
+        // indentation, blank lines and ';' comments carry no code
+        int32_t m;
+        for (m = 0; m < line_len && isspace((unsigned char) s_line[m]); m++);
+        if (m == line_len || s_line[m] == ';')
+            continue;
+        int32_t p;
+        for (p = m; p < line_len && !isspace((unsigned char) s_line[p]) && s_line[p] != ';'; p++);
+        const char *mnemonic = s_line + m;
+        int32_t mnemonic_len = p - m;
+
+        // the parameter follows a single separator; it runs to the end of the line for strings,
+        // anywhere else a ';' ends it and surrounding blanks are dropped
+        const char *param = s_line + (p < line_len ? p + 1 : p);
+        int32_t param_len = line_len - (int32_t) (param - s_line);
+        const ConceptOpcode_t *opcode = opcode_lookup(mnemonic, (size_t) mnemonic_len);
+        if (opcode == NULL || opcode->payload != CONCEPT_PAYLOAD_STRING) {
+            const char *comment = memchr(s_line + p, ';', (size_t) (line_len - p));
+            if (comment != NULL)
+                param_len = (int32_t) (comment - param);
+            while (param_len > 0 && isspace((unsigned char) param[0])) param++, param_len--;
+            while (param_len > 0 && isspace((unsigned char) param[param_len - 1])) param_len--;
+        }
+
+        BOOL is_def = (mnemonic_len == 4 && !strncmp(mnemonic, ".def", 4));
+        if (is_def || (mnemonic_len == 9 && !strncmp(mnemonic, "procedure", 9))) {
+            if (procedure_counter >= 0)
+                end_procedure(procedure, counter, procedure_counter, &labels, &label_fixups);
+
+            int32_t args = 0, locals = 0;
+            int32_t name_len = is_def ? parse_procedure_header(param, param_len, &args, &locals) : param_len;
+            if (name_len <= 0) {
+                printf("\n Parse: ERR: Malformed procedure header @ line %d.\n", d);
+                concept_exit(130);
+            }
+            char *proc_name = substring((char *) param, 0, name_len);
+
+            procedure_counter++;
+#ifdef DEBUG
+            printf("\n Parse: Found 1 procedure. %d th @ line %d listing:  >> %s", procedure_counter, d, proc_name);
+#endif
+            if (!symtab_define(&procedures, proc_name, strlen(proc_name), procedure_counter)) {
+                printf("\n Parse: ERR: Procedure %s defined twice.\n", proc_name);
+                concept_exit(130);
+            }
+            if (procedure_counter >= procedures_allocated) {
+                size_t used = (size_t) procedures_allocated;
+                procedures_allocated *= 2;
+                procedure_call_table = arena_grow(&program_arena, procedure_call_table, sizeof(char *) * used,
+                                                  sizeof(char *) * procedures_allocated);
+                procedure_length_table = arena_grow(&program_arena, procedure_length_table, sizeof(int32_t) * used,
+                                                    sizeof(int32_t) * procedures_allocated);
+                procedure_args_table = arena_grow(&program_arena, procedure_args_table, sizeof(int32_t) * used,
+                                                  sizeof(int32_t) * procedures_allocated);
+                procedure_locals_table = arena_grow(&program_arena, procedure_locals_table, sizeof(int32_t) * used,
+                                                    sizeof(int32_t) * procedures_allocated);
+                program = arena_grow(&program_arena, program, sizeof(ConceptInstruction_t *) * used,
+                                     sizeof(ConceptInstruction_t *) * procedures_allocated);
+            }
+            procedure_call_table[procedure_counter] = proc_name;
+            procedure_args_table[procedure_counter] = args;
+            procedure_locals_table[procedure_counter] = locals;
+
+            capacity = 16;
+            counter = 0;
+            procedure = (ConceptInstruction_t *) arena_alloc(&program_arena, sizeof(ConceptInstruction_t) * capacity);
+            continue;
+        }
+
+        if (procedure_counter < 0) // nothing outside of procedures is executed
+            continue;
+
+        // "<label>:" marks the index of the next instruction
+        if (mnemonic_len > 1 && mnemonic[mnemonic_len - 1] == ':' && param_len == 0) {
+            if (!symtab_define(&labels, mnemonic, (size_t) (mnemonic_len - 1), counter)) {
+                printf("\n Parse: ERR: Label %.*s defined twice. Procedure [%d].\n", mnemonic_len - 1, mnemonic,
+                       procedure_counter);
+                concept_exit(130);
+            }
+            continue;
+        }
+
+#ifdef DEBUG
+        printf(" \nlexer: PSA: Resolved 1 line. Instr: ||%.*s||.", mnemonic_len, mnemonic);
+        if (param_len > 0)
+            printf(" \n\tParam has flag. Flag: %.*s.", param_len, param);
+#endif
+
+        if (opcode == NULL) {
+            printf("\n lexer:PSA: ERR: INVALID INSTR DETECTED > ABRT. Currently assigning @ line [%d]. Program [%d].",
+                   (counter), procedure_counter);
+            concept_exit(130);
+        } // ABRT
+
+        if (counter >= capacity) {
+            procedure = arena_grow(&program_arena, procedure, sizeof(ConceptInstruction_t) * capacity,
+                                   sizeof(ConceptInstruction_t) * capacity * 2);
+            capacity *= 2;
+        }
+        procedure[counter].instr = (uint16_t) opcode->code;
+        procedure[counter].reserved = 0;
+        procedure[counter].as.i = 0;
+        if (opcode->payload != CONCEPT_PAYLOAD_NONE) {
+            if (param_len <= 0) concept_exit(130);
+            parse_operand(opcode, param, param_len, &procedure[counter], &strings_capacity);
+
+            if (opcode->payload == CONCEPT_PAYLOAD_TARGET && !is_numeric_target(param, param_len)) {
+                fixup_add(&label_fixups, substring((char *) param, 0, param_len), procedure_counter, counter);
+            } else if (opcode->payload == CONCEPT_PAYLOAD_PROCEDURE) {
+                // "call f()" names the same procedure as "call f"
+                if (param_len > 2 && param[param_len - 2] == '(' && param[param_len - 1] == ')')
+                    param_len -= 2;
+                ConceptSymbol_t *callee = symtab_find(&procedures, param, (size_t) param_len);
+                if (callee != NULL)
+                    procedure[counter].as.i = callee->value;
+                else // forward call
+                    fixup_add(&call_fixups, substring((char *) param, 0, param_len), procedure_counter, counter);
+            } else if (opcode->payload == CONCEPT_PAYLOAD_GLOBAL) {
+                ConceptSymbol_t *global = symtab_find(&globals, param, (size_t) param_len);
+                if (global == NULL) { // first use declares it
+                    symtab_define(&globals, param, (size_t) param_len, globals.count);
+                    global = symtab_find(&globals, param, (size_t) param_len);
+                }
+                procedure[counter].as.i = global->value;
+            }
+        }
+#ifdef DEBUG
+        printf("\nlexer: PSA: Instr is %s. Currently assigning @ line [%d]. Program [%d].", opcode->mnemonic,
+               (counter), procedure_counter);
+#endif
+
+        counter++;
+    }
+
+    if (procedure_counter < 0)
+        on_error(CONCEPT_COMPILER_ERROR, "No procedure found.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    end_procedure(procedure, counter, procedure_counter, &labels, &label_fixups);
+
+    if (!fixup_resolve(&call_fixups, &procedures)) {
+        printf("Illegal call.\n");
+        concept_exit(130);
+    }
+
+    procedure_call_table_length = procedure_counter + 1;
+    procedure_length_table_length = procedure_counter + 1;
+    global_table_length = globals.count;
+
+#ifdef DEBUG
+    printf(ANSI_COLOR_RESET ANSI_COLOR_RED"\n\n CONGRADULATIONS! Successfully parsed everything into Bytecode. Starting the bytecode interpreter...\n"ANSI_COLOR_RESET);
+#endif
+}
+
+/*
+ * Precompiled bytecode image (.fngc)
+ * ----------------------------------
+ * An image holds the already resolved program[][], procedure_length_table, procedure names and string_pool.
+ * Instructions carry their operands inline and strings by offset, so they are written exactly as they sit in
+ * memory and need no relocation: the loader maps the file privately and points program[] and string_pool
+ * straight into the mapping. Only load-time rewrites such as superinstruction fusion copy a code page.
+ *
+ * Layout: header | procedure table | instructions | constant pool (string_pool, then names). Native byte order.
+ */
+
+#define CONCEPT_IMAGE_MAGIC "FNGC"
+#define CONCEPT_IMAGE_VERSION 4
+#define CONCEPT_IMAGE_BYTE_ORDER 0x01020304
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t procedure_count;
+    uint32_t global_count;
+    uint32_t reserved;
+    uint64_t instruction_count;
+    uint64_t procedure_table_offset;
+    uint64_t code_offset;
+    uint64_t pool_offset;
+    uint64_t pool_size;
+    uint64_t strings_size; // string_pool, at the start of the constant pool
+} ConceptImageHeader_t;
+
+typedef struct {
+    uint64_t name_offset; // into the constant pool
+    uint64_t code_index; // first instruction
+    int32_t length;
+    int32_t args;
+    int32_t locals;
+    int32_t reserved;
+} ConceptImageProcedure_t;
+
+struct {
+    void *base;
+    size_t size;
+} concept_image;
+
+// Growable byte buffer used while writing an image
+typedef struct {
+    char *bytes;
+    size_t len;
+    size_t cap;
+} ConceptBuffer_t;
+
+static uint64_t buffer_append(ConceptBuffer_t *buf, const void *data, size_t size) {
+    size_t aligned = (buf->len + 7) & ~(size_t) 7; // keep every entry 8-byte aligned
+    if (aligned + size > buf->cap) {
+        buf->cap = (aligned + size) * 2;
+        buf->bytes = realloc(buf->bytes, buf->cap);
+        if (buf->bytes == NULL)
+            on_error(CONCEPT_GENERAL_ERROR, "Out of memory while writing image.", CONCEPT_STATE_ERROR,
+                     CONCEPT_WARN_EXITNOW);
+    }
+    memset(buf->bytes + buf->len, 0, aligned - buf->len);
+    memcpy(buf->bytes + aligned, data, size);
+    buf->len = aligned + size;
+    return aligned;
+}
+
+// Write the currently parsed program into a .fngc image
+void write_image(char *file_path) {
+    ConceptBuffer_t pool = {NULL, 0, 0};
+
+    uint64_t instruction_count = 0;
+    for (int32_t p = 0; p < procedure_length_table_length; p++)
+        instruction_count += procedure_length_table[p];
+
+    ConceptImageProcedure_t *procedures = calloc((size_t) procedure_length_table_length,
+                                                 sizeof(ConceptImageProcedure_t));
+    if (procedures == NULL)
+        on_error(CONCEPT_GENERAL_ERROR, "Out of memory while writing image.", CONCEPT_STATE_ERROR,
+                 CONCEPT_WARN_EXITNOW);
+
+    // sconst offsets stay valid as string_pool goes first
+    if (string_pool_size)
+        buffer_append(&pool, string_pool, string_pool_size);
+    uint64_t strings_size = pool.len;
+    uint64_t code_index = 0;
+    for (int32_t p = 0; p < procedure_length_table_length; p++) {
+        char *name = procedure_call_table[p];
+        procedures[p].name_offset = buffer_append(&pool, name, strlen(name) + 1);
+        procedures[p].code_index = code_index;
+        procedures[p].length = procedure_length_table[p];
+        procedures[p].args = procedure_args_table[p];
+        procedures[p].locals = procedure_locals_table[p];
+        code_index += procedure_length_table[p];
+    }
+
+    ConceptImageHeader_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CONCEPT_IMAGE_MAGIC, 4);
+    header.version = CONCEPT_IMAGE_VERSION;
+    header.byte_order = CONCEPT_IMAGE_BYTE_ORDER;
+    header.procedure_count = (uint32_t) procedure_length_table_length;
+    header.global_count = (uint32_t) global_table_length;
+    header.instruction_count = instruction_count;
+    header.procedure_table_offset = sizeof(ConceptImageHeader_t);
+    header.code_offset = header.procedure_table_offset + sizeof(ConceptImageProcedure_t) * header.procedure_count;
+    header.pool_offset = header.code_offset + sizeof(ConceptInstruction_t) * instruction_count;
+    header.pool_size = pool.len;
+    header.strings_size = strings_size;
+
+    FILE *fp = fopen(file_path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Error opening file.\n");
+        concept_exit(2);
+    }
+    BOOL written = fwrite(&header, sizeof(header), 1, fp) == 1
+                   && fwrite(procedures, sizeof(ConceptImageProcedure_t), header.procedure_count, fp)
+                      == header.procedure_count;
+    for (int32_t p = 0; p < procedure_length_table_length && written; p++)
+        written = fwrite(program[p], sizeof(ConceptInstruction_t), (size_t) procedure_length_table[p], fp)
+                  == (size_t) procedure_length_table[p];
+    if (!written || (pool.len && fwrite(pool.bytes, 1, pool.len, fp) != pool.len)) {
+        fprintf(stderr, "err write_image(): Could not write image.\n");
+        concept_exit(5);
+    }
+    fclose(fp);
+
+    free(procedures);
+    free(pool.bytes);
+}
+
+// TRUE if the file starts with the image magic
+BOOL is_image(char *file_path) {
+    char magic[4];
+    FILE *fp = fopen(file_path, "rb");
+    if (fp == NULL)
+        return FALSE;
+    size_t n = fread(magic, 1, 4, fp);
+    fclose(fp);
+    return (n == 4 && !memcmp(magic, CONCEPT_IMAGE_MAGIC, 4));
+}
+
+// Map a .fngc image and point the program tables into it
+void load_image(char *file_path) {
+    int fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error opening file.\n");
+        concept_exit(2);
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t) st.st_size < sizeof(ConceptImageHeader_t))
+        on_error(CONCEPT_COMPILER_ERROR, "Image truncated.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+
+    // private and writable: only the pages rewritten at load time are ever copied
+    char *base = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        on_error(CONCEPT_GENERAL_ERROR, "Could not map image.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    concept_image.base = base;
+    concept_image.size = (size_t) st.st_size;
+
+    ConceptImageHeader_t *header = (ConceptImageHeader_t *) base;
+    if (memcmp(header->magic, CONCEPT_IMAGE_MAGIC, 4) || header->byte_order != CONCEPT_IMAGE_BYTE_ORDER)
+        on_error(CONCEPT_COMPILER_ERROR, "Not a Conceptum image.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    if (header->version != CONCEPT_IMAGE_VERSION)
+        on_error(CONCEPT_COMPILER_ERROR, "Unsupported image version.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    if (header->procedure_table_offset + sizeof(ConceptImageProcedure_t) * header->procedure_count > header->code_offset
+        || header->code_offset + sizeof(ConceptInstruction_t) * header->instruction_count > header->pool_offset
+        || header->pool_offset + header->pool_size > concept_image.size || header->strings_size > header->pool_size
+        || header->code_offset % sizeof(ConceptInstruction_t) != 0)
+        on_error(CONCEPT_COMPILER_ERROR, "Image truncated.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+
+    ConceptImageProcedure_t *procedures = (ConceptImageProcedure_t *) (base + header->procedure_table_offset);
+    ConceptInstruction_t *instructions = (ConceptInstruction_t *) (base + header->code_offset);
+    char *pool = base + header->pool_offset;
+    // every string, names included, has to end inside the pool
+    if (header->pool_size && pool[header->pool_size - 1] != '\0')
+        on_error(CONCEPT_COMPILER_ERROR, "Image constant pool corrupt.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    string_pool = pool;
+    string_pool_size = (uint32_t) header->strings_size;
+
+    for (uint64_t n = 0; n < header->instruction_count; n++) {
+        int32_t instr = instructions[n].instr;
+        if (instr >= CONCEPT_OPCODE_MAX || concept_opcodes[instr].mnemonic == NULL
+            || concept_opcodes[instr].length != 1)
+            on_error(CONCEPT_COMPILER_ERROR, "Image contains an unknown instruction.", CONCEPT_STATE_ERROR,
+                     CONCEPT_WARN_EXITNOW);
+        if (concept_opcodes[instr].payload == CONCEPT_PAYLOAD_STRING && instructions[n].as.s >= header->strings_size)
+            on_error(CONCEPT_COMPILER_ERROR, "Image string out of range.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    }
+
+    int32_t count = (int32_t) header->procedure_count;
+    procedure_call_table = (char **) arena_alloc(&program_arena, sizeof(char *) * count);
+    procedure_length_table = (int32_t *) arena_alloc(&program_arena, sizeof(int32_t) * count);
+    procedure_args_table = (int32_t *) arena_alloc(&program_arena, sizeof(int32_t) * count);
+    procedure_locals_table = (int32_t *) arena_alloc(&program_arena, sizeof(int32_t) * count);
+    program = (ConceptInstruction_t **) arena_alloc(&program_arena, sizeof(ConceptInstruction_t *) * count);
+    for (int32_t p = 0; p < count; p++) {
+        if (procedures[p].name_offset >= header->pool_size || procedures[p].length < 0
+            || procedures[p].code_index + procedures[p].length > header->instruction_count
+            || procedures[p].args < 0 || procedures[p].locals < 0)
+            on_error(CONCEPT_COMPILER_ERROR, "Image procedure table corrupt.", CONCEPT_STATE_ERROR,
+                     CONCEPT_WARN_EXITNOW);
+        procedure_call_table[p] = pool + procedures[p].name_offset;
+        procedure_length_table[p] = procedures[p].length;
+        procedure_args_table[p] = procedures[p].args;
+        procedure_locals_table[p] = procedures[p].locals;
+        program[p] = instructions + procedures[p].code_index;
+        for (int32_t i = 0; i < procedures[p].length; i++) {
+            if (concept_opcodes[program[p][i].instr].payload == CONCEPT_PAYLOAD_LOCAL
+                && (uint32_t) program[p][i].as.i >= (uint32_t) FRAME_SLOTS(p))
+                on_error(CONCEPT_COMPILER_ERROR, "Image local slot out of frame.", CONCEPT_STATE_ERROR,
+                         CONCEPT_WARN_EXITNOW);
+            if (concept_opcodes[program[p][i].instr].payload == CONCEPT_PAYLOAD_GLOBAL
+                && (uint32_t) program[p][i].as.i >= header->global_count)
+                on_error(CONCEPT_COMPILER_ERROR, "Image global out of range.", CONCEPT_STATE_ERROR,
+                         CONCEPT_WARN_EXITNOW);
+        }
+    }
+    procedure_call_table_length = count;
+    procedure_length_table_length = count;
+    global_table_length = (int32_t) header->global_count;
+}
+
+void unload_image() {
+    if (concept_image.base != NULL) {
+        munmap(concept_image.base, concept_image.size);
+        concept_image.base = NULL;
+        concept_image.size = 0;
+    }
+}
+
+
+// Unload the program: its whole region goes at once
+void cleanup() {
+#ifdef DEBUG
+    printf("\ncleanup(): Memfree\n");
+#endif
+    arena_free(&program_arena);
+    arena_free(&scratch_arena); // all that is left of a load cut short by an error
+    unload_image();
+#ifdef DEBUG
+    printf("\ncleanup: Finished executing: 1\n");
+#endif
+}
+
+// Read a .fng source file and parse it into program[][]
+void load_source(char *arg) {
+    // read in the program
+
+#ifdef MEASURE_READ_FILE_TIME
+    clock_t prg_read_time = clock();
+#endif
+    read_prog(arg);
+#ifdef MEASURE_READ_FILE_TIME
+    clock_t prg_read_time_out = clock();
+    clock_t prg_read_time_diff = prg_read_time_out - prg_read_time;
+    printf(ANSI_COLOR_RESET ANSI_COLOR_BLUE"\n\n READPROGRAM TOTAL RUNTIME:%lu\n\n" ANSI_COLOR_RESET,
+           prg_read_time_diff * 1000000000 / CLOCKS_PER_SEC);
+#endif
+    if (concept_program.code == NULL || concept_program.len == 0)
+        on_error(CONCEPT_COMPILER_ERROR, "Input program not found.", CONCEPT_STATE_CATASTROPHE, CONCEPT_ABORT);
+
+#ifdef DEBUG
+    printf("\n-=-=-=-=-=-=-=-=Your Program Listings=-=-=-=-=-=-=-=-=-\n");
+    fwrite(concept_program.code, 1, concept_program.len, stdout);
+    printf("\n-=-=-=-=-=-=-=-=End  Program Listings=-=-=-=-=-=-=-=-=-\n");
+#endif
+
+    parse_procedures();
+    inline_procedures();
+    optimize_procedures();
+    mark_tail_calls();
+    unmap_prog();
+}
+
+// Assemble a .fng source file into a .fngc image
+void assemble(char *source_path, char *image_path) {
+    load_source(source_path);
+    verify_procedures(); // malformed programs never make it into an image
+    write_image(image_path);
+    cleanup();
+}
+
+#ifdef MEASURE_OPCODE_PAIRS
+// Print the most frequent executed opcode pairs, the candidates for superinstructions
+static void print_opcode_pairs() {
+    printf(ANSI_COLOR_RESET ANSI_COLOR_BLUE "\n OPCODE PAIRS (most frequent first):\n" ANSI_COLOR_RESET);
+    for (int32_t rank = 0; rank < 20; rank++) {
+        int32_t best_a = 0, best_b = 0;
+        for (int32_t a = 0; a < CONCEPT_OPCODE_MAX; a++)
+            for (int32_t b = 0; b < CONCEPT_OPCODE_MAX; b++)
+                if (opcode_pairs[a][b] > opcode_pairs[best_a][best_b])
+                    best_a = a, best_b = b;
+        if (opcode_pairs[best_a][best_b] == 0)
+            break;
+        printf("  %-10s %-10s %lu\n", concept_opcodes[best_a].mnemonic, concept_opcodes[best_b].mnemonic,
+               (unsigned long) opcode_pairs[best_a][best_b]);
+        opcode_pairs[best_a][best_b] = 0;
+    }
+}
+#endif
+
+// The collector's roots: every slot of the running operand stack up to its top, which covers the argument and
+// local slots of all active frames, and the globals.
+static ConceptStack_t *gc_stack;
+static ConceptValue_t *gc_stack_bottom;
+
+static void gc_roots(ConceptGcVisitor_t visit) {
+    // eval() shifts the stack's view per frame, the absolute top is relative to the bottom
+    int32_t top = (int32_t) (gc_stack->operand_stack - gc_stack_bottom) + gc_stack->top;
+    for (int32_t s = 0; s <= top; s++)
+        if (gc_stack_bottom[s].type == CONCEPT_VALUE_OBJECT)
+            visit(&gc_stack_bottom[s].as.o);
+    for (int32_t g = 0; g < global_table_length; g++)
+        if (global_table[g].type == CONCEPT_VALUE_OBJECT)
+            visit(&global_table[g].as.o);
+}
+
+// Start the collector for a run on the given stack
+void gc_start(ConceptStack_t *stack) {
+    gc_stack = stack;
+    gc_stack_bottom = stack->operand_stack;
+    gc_init(gc_roots);
+}
+
+// Load a source file or image and get it ready to run on the given tier: verified, counters cleared, translated
+// (and compiled) or fused (and threaded), globals allocated. The JIT binds its code to the stack and frames passed here.
+void load_program(char *arg, int32_t tier, ConceptStack_t *stack, ConceptFrameStack_t *frames) {
+    // precompiled images are mapped as they are, sources go through the parser
+    if (is_image(arg))
+        load_image(arg);
+    else
+        load_source(arg);
+    verify_procedures();
+    procedure_call_counts = arena_alloc(&program_arena, sizeof(uint32_t) * procedure_length_table_length);
+    procedure_backedge_counts = arena_alloc(&program_arena, sizeof(uint32_t) * procedure_length_table_length);
+    memset(procedure_call_counts, 0, sizeof(uint32_t) * procedure_length_table_length);
+    memset(procedure_backedge_counts, 0, sizeof(uint32_t) * procedure_length_table_length);
+    if (tier == CONCEPT_TIER_REGISTER || tier == CONCEPT_TIER_JIT) {
+        translate_procedures();
+        if (tier == CONCEPT_TIER_JIT)
+            jit_compile_procedures(stack, frames);
+    } else {
+#ifndef MEASURE_OPCODE_PAIRS // pairs are counted on the plain instruction stream
+        fuse_superinstructions();
+#endif
+#ifdef THREADED_DISPATCH
+        thread_procedures();
+#endif
+    }
+    alloc_globals();
+    arena_free(&scratch_arena);
+}
+
+void run(char *arg, int32_t tier) {
+
+    // Allocate the operand stack
+    // -=-=-=-=-=-=-=-=-=-=-=-=-=-
+    // One stack is shared by all frames; globals live in the global table, sized by the loader.
+    // Both come from the run region.
+
+    ConceptStack_t f_stack;
+    stack_alloc(&f_stack, (size_t) CONCEPTFP_MAX_LENGTH); // shared by all frames
+
+    // One frame record per active call, up to CONCEPTREC_MAX_LENGTH nested calls
+    ConceptFrameStack_t frame_stack;
+    frame_stack_alloc(&frame_stack, CONCEPTREC_MAX_LENGTH);
+
+    clock_t prg_parse_time_start = clock();
+    load_program(arg, tier, &f_stack, &frame_stack);
+    clock_t prg_parse_time_end = clock();
+    printf(ANSI_COLOR_RESET ANSI_COLOR_BLUE "\n\n PARSEPROGRAM TOTAL RUNTIME:%lu\n\n" ANSI_COLOR_RESET,
+           (prg_parse_time_end - prg_parse_time_start) * 1000000000 / CLOCKS_PER_SEC);
+#ifdef DEBUG
+    for (int i = 0; i < procedure_length_table_length; i++) {
+        for (int j = 0; j < procedure_length_table[i]; j++) {
+            int instr = program[i][j].instr;
+            printf("\n%d\n", instr);
+        }
+    }
+#endif
+
+    //execute
+    clock_t diff;
+    gc_start(&f_stack);
+
+    if (tier == CONCEPT_TIER_TIERED)
+        tier_start(&f_stack, &frame_stack, CONCEPT_TIER_THRESHOLD);
+
+    stats_start(tier == CONCEPT_TIER_REGISTER ? "register" : tier == CONCEPT_TIER_JIT ? "jit"
+                : tier == CONCEPT_TIER_TIERED ? "tiered" : "stack");
+    profile_start(&frame_stack);
+    clock_t start = clock(); // start timing
+
+    if (tier == CONCEPT_TIER_REGISTER || tier == CONCEPT_TIER_JIT)
+        reg_eval(0, &f_stack, global_table, &frame_stack);
+    else
+        eval(0, &f_stack, global_table, &frame_stack, 0); // loop
+    diff = clock() - start; // calculate return
+    profile_stop();
+    stats_stop();
+    tier_stop();
+
+    printf(ANSI_COLOR_RESET ANSI_COLOR_BLUE"\n PROCESS TOTAL RUNTIME: %lu us\n\n" ANSI_COLOR_RESET,
+           diff * 1000000 / CLOCKS_PER_SEC);
+#ifdef MEASURE_OPCODE_PAIRS
+    print_opcode_pairs();
+#endif
+
+#ifdef DEBUG
+    printf(ANSI_COLOR_RESET ANSI_COLOR_RED "\nCONCEPTUM_MAIN: Finished executing. Cleaning up...\n" ANSI_COLOR_RESET);
+#endif
+    frame_stack_free(&frame_stack);
+    stack_free(&f_stack);
+    jit_release();
+    gc_shutdown();
+    arena_free(&run_arena); // stacks, frames and globals
+    cleanup();
+}
+
@@ -0,0 +1,599 @@
+/*
+ * vm.h
+ *
+ * The Conceptum VM shared by the Conceptum executable, libconceptum and the tools: values, stacks and frames,
+ * the loaded program, and the entry points of the loader and the engines
+ * Copyright (c) 2016 Ruijie Fang <ruijief@acm.org>
+ */
+
+#ifndef VM_H_
+#define VM_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <signal.h>
+
+// MeMmAn
+#include "memman.h"
+#include "gc.h"
+
+// Instruction set, see opcodes.def
+#include "opcodes.h"
+
+// Limits
+
+#define CONCEPTIP_MAX_LENGTH 30000
+#define CONCEPTFP_MAX_LENGTH 30000
+#define CONCEPTREC_MAX_LENGTH 10000
+
+// DEBUG prettifiers
+
+#define ANSI_COLOR_RED     "\x1b[31m"
+#define ANSI_COLOR_GREEN   "\x1b[32m"
+#define ANSI_COLOR_YELLOW  "\x1b[33m"
+#define ANSI_COLOR_BLUE    "\x1b[34m"
+#define ANSI_COLOR_MAGENTA "\x1b[35m"
+#define ANSI_COLOR_CYAN    "\x1b[36m"
+#define ANSI_COLOR_RESET   "\x1b[0m"
+
+/* ========================
+ * Error handling functions
+ * ========================
+ */
+
+// Error types
+#define CONCEPT_COMPILER_ERROR 200
+#define CONCEPT_STACK_OVERFLOW 201
+#define CONCEPT_BUFFER_OVERFLOW 202
+#define CONCEPT_INVALID_PARAMETER 203
+#define CONCEPT_INVALID_TYPE 204
+#define CONCEPT_GENERAL_ERROR 205
+#define CONCEPT_FILE_EMPTY 206
+
+#define CONCEPT_STATE_INFO 90
+#define CONCEPT_STATE_WARNING 91
+#define CONCEPT_STATE_ERROR 92
+#define CONCEPT_STATE_CATASTROPHE 93
+#define CONCEPT_WARN_NOEXIT 94
+#define CONCEPT_WARN_EXITNOW 95
+#define CONCEPT_NOWARNING_EXIT 96
+#define CONCEPT_ABORT 97
+
+// DEBUG settings
+#if 0 // change to 0 if no DEBUG is needed
+#ifndef DEBUG
+#define DEBUG // debug params
+#endif
+#endif
+
+// dispatch settings
+#if 0 // change to 1 for the direct-threaded (computed goto) dispatch engine instead of the switch loop
+#ifndef THREADED_DISPATCH
+#define THREADED_DISPATCH
+#endif
+#endif
+
+// computed goto is a GNU extension, fall back to the portable switch loop elsewhere
+#if defined(THREADED_DISPATCH) && !defined(__GNUC__)
+#undef THREADED_DISPATCH
+#endif
+
+// timing settings
+#if 0 // change to 0 if no read text file timing is needed
+#ifndef MEASURE_READ_FILE_TIME
+#define MEASURE_READ_FILE_TIME
+#endif
+#endif
+
+#if 0 // change to 0 if no JIT timing is needed
+#ifndef MEASURE_PARSE_TIME
+#define MEASURE_PARSE_TIME
+#endif
+#endif
+
+#if 0 // change to 1 to count executed opcode pairs, which is what picks the superinstructions
+#ifndef MEASURE_OPCODE_PAIRS
+#define MEASURE_OPCODE_PAIRS
+#endif
+#endif
+
+#if 1 // change to 0 if do not measure full timing
+#ifndef MEASURE_FULL_RUNTIME
+#define MEASURE_FULL_RUNTIME
+#endif
+#endif
+
+// JIT settings: --jit compiles to native code on x86-64 Linux, elsewhere it runs the register tier
+#if defined(__x86_64__) && defined(__linux__)
+#define CONCEPT_JIT
+#endif
+
+// Fatal errors end the process. An embedding host (src/conceptum.c) arms concept_error_jump around its calls and
+// gets the exit status back instead; it is per thread, so errors on the tier worker still end the process.
+extern _Thread_local jmp_buf *concept_error_jump;
+
+/**
+ * End the process with status, or return it to the host through concept_error_jump.
+ *
+ * @param status int32_t
+ * @return void
+ */
+_Noreturn void concept_exit(int32_t status);
+/**
+ * Report an error; CONCEPT_STATE_ERROR and CONCEPT_STATE_CATASTROPHE end the process through concept_exit().
+ *
+ * @param error int32_t CONCEPT_*_ERROR
+ * @param msg char*
+ * @param action int32_t CONCEPT_STATE_*
+ * @param if_exception int32_t CONCEPT_WARN_* or exit status
+ * @return void
+ */
+void on_error(int32_t error, char *msg, int32_t action, int32_t if_exception);
+
+/* ========================
+ * Utils
+ * ========================
+ */
+
+// Conceptual Boolean
+#define FALSE 0;
+#define TRUE 1;
+typedef int32_t BOOL;
+
+
+// Conceptual String
+typedef struct {
+    char (*value);
+    int32_t len;
+} ConceptString_t;
+
+// Conceptual Value types
+#define CONCEPT_VALUE_VOID 0
+#define CONCEPT_VALUE_INT 1
+#define CONCEPT_VALUE_FLOAT 2
+#define CONCEPT_VALUE_CHAR 3
+#define CONCEPT_VALUE_BOOL 4
+#define CONCEPT_VALUE_STRING 5
+#define CONCEPT_VALUE_OBJECT 6 // heap object owned by the collector, see gc.h
+
+// Conceptual Value
+// A tagged value stored inline in the stack array. Scalars never touch the heap;
+// string constants point into the program's string_pool, strings built at runtime are collected objects.
+typedef struct {
+    int32_t type;
+    union {
+        int32_t i; // also holds BOOL
+        float f;
+        char c;
+        char *s;
+        ConceptObject_t *o;
+        void *v;
+    } as;
+} ConceptValue_t;
+
+// Conceptual Stack
+typedef struct ConceptStack {
+    int32_t top;
+    int32_t size;
+    ConceptValue_t (*operand_stack);
+} ConceptStack_t;
+
+// Frame record of a procedure invocation
+// A frame occupies the operand stack from its base: first the argument and local slots, then its operands.
+typedef struct {
+    int32_t return_pc; // the call instruction in the caller
+    int32_t procedure; // the caller
+    int32_t stack_base; // where the caller's slots start in the operand stack
+} ConceptFrame_t;
+
+// Contiguous stack of frame records
+typedef struct {
+    int32_t top;
+    int32_t size;
+    ConceptFrame_t (*frames);
+} ConceptFrameStack_t;
+
+// One instruction in 8 bytes: the opcode with its operand inline, so a procedure is a single flat array and
+// fetching an operand never leaves the instruction stream
+typedef struct {
+    uint16_t instr;
+    uint16_t reserved;
+    union {
+        int32_t i; // also holds BOOL, jump targets, procedure, local and global indices
+        float f;
+        char c;
+        uint32_t s; // offset of a NUL-terminated string in string_pool
+    } as;
+} ConceptInstruction_t;
+
+/*
+ * The loaded program
+ */
+
+extern char **procedure_call_table;
+extern int32_t procedure_call_table_length;
+
+extern int32_t *procedure_length_table;
+extern int32_t procedure_length_table_length;
+
+// Argument and local slot counts, indexed like procedure_length_table
+extern int32_t *procedure_args_table;
+extern int32_t *procedure_locals_table;
+// Deepest operand stack of each procedure, proven by verify_procedures()
+extern int32_t *procedure_max_depth_table;
+
+// Program globals, one slot per global name; gload/gstore carry the slot index
+extern ConceptValue_t *global_table;
+extern int32_t global_table_length;
+
+extern ConceptInstruction_t **program;
+
+// Every string constant of the program back to back, each NUL-terminated; sconst holds an offset into it
+extern char *string_pool;
+extern uint32_t string_pool_size;
+
+// Hotness of each procedure, counted by eval(): invocations, and jumps backwards inside it
+extern uint32_t *procedure_call_counts;
+extern uint32_t *procedure_backedge_counts;
+// A procedure whose two counts add up to this is handed to the tiering compiler, see tier_request()
+extern uint32_t tier_threshold;
+
+// Native code of each procedure compiled by the JIT, NULL where the procedure is interpreted.
+// It takes the procedure's registers, its arguments already in place, and leaves the result in the first one.
+typedef void (*ConceptJitProcedure_t)(ConceptValue_t *regs);
+extern _Atomic(ConceptJitProcedure_t) *jit_program;
+// Per compiled procedure, indexed by instruction: native entries into the middle of a running invocation at
+// jump targets, taking the frame's slots. NULL where the procedure is not compiled or has no such entries.
+extern _Atomic(ConceptJitProcedure_t *) *jit_osr;
+
+#define FRAME_SLOTS(p) (procedure_args_table[p] + procedure_locals_table[p])
+
+/*
+ * Value constructors
+ */
+
+static inline ConceptValue_t value_int(int32_t i) {
+    ConceptValue_t v;
+    v.type = CONCEPT_VALUE_INT;
+    v.as.i = i;
+    return v;
+}
+
+static inline ConceptValue_t value_float(float f) {
+    ConceptValue_t v;
+    v.type = CONCEPT_VALUE_FLOAT;
+    v.as.f = f;
+    return v;
+}
+
+static inline ConceptValue_t value_char(char c) {
+    ConceptValue_t v;
+    v.type = CONCEPT_VALUE_CHAR;
+    v.as.i = 0;
+    v.as.c = c;
+    return v;
+}
+
+static inline ConceptValue_t value_bool(BOOL b) {
+    ConceptValue_t v;
+    v.type = CONCEPT_VALUE_BOOL;
+    v.as.i = b;
+    return v;
+}
+
+static inline ConceptValue_t value_string(char *s) {
+    ConceptValue_t v;
+    v.type = CONCEPT_VALUE_STRING;
+    v.as.s = s;
+    return v;
+}
+
+static inline ConceptValue_t value_object(ConceptObject_t *o) {
+    ConceptValue_t v;
+    v.type = CONCEPT_VALUE_OBJECT;
+    v.as.o = o;
+    return v;
+}
+
+static inline ConceptValue_t value_void(void *p) {
+    ConceptValue_t v;
+    v.type = CONCEPT_VALUE_VOID;
+    v.as.v = p;
+    return v;
+}
+
+
+/*
+ * Stack Operations Functions
+ */
+
+// Check if stack is empty TRUE: empty FALSE: not empty
+static inline BOOL stack_is_empty(ConceptStack_t *stack) {
+    return (stack->top == (-1));
+}
+
+// Check if stack is full TRUE: full FALSE: not full
+static inline BOOL stack_is_full(ConceptStack_t *stack) {
+    return (stack->top >= stack->size - 1);
+}
+
+#ifdef DEBUG // only the DEBUG stack_push_fast below uses the checked push, likewise the checked peek
+// Push a value into stack
+static inline void stack_push(ConceptStack_t *stack, ConceptValue_t value) {
+
+    // Exit when full
+    if (stack_is_full(stack))
+        on_error(CONCEPT_STACK_OVERFLOW, "Stack is full, operation abort.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+
+#ifdef DEBUG
+    printf("\nSTACK: PUSH, type %d", value.type);
+#endif
+
+    // Push while incrementing top value
+    stack->operand_stack[++(stack->top)] = value; // Increase by one BEFORE pushing
+
+}
+#endif
+
+// Pop a value out of the stack
+static inline ConceptValue_t stack_pop(ConceptStack_t *stack) {
+    if (stack_is_empty(stack)) {
+        on_error(CONCEPT_GENERAL_ERROR, "Stack is empty. Returning a void value.", CONCEPT_STATE_INFO,
+                 CONCEPT_WARN_NOEXIT);
+        return value_void(NULL); // Nothing is stored yet!
+    }
+
+    ConceptValue_t ret = stack->operand_stack[(stack->top)--]; // Decrease by one AFTER popping
+
+#ifdef DEBUG
+    printf("\nSTACK: POP, type %d, current top %d", ret.type, (stack->top));
+#endif
+    return ret;
+}
+
+#ifdef DEBUG // stack_peek_fast in DEBUG builds
+// Peek at the top value without popping it
+static inline ConceptValue_t *stack_peek(ConceptStack_t *stack) {
+    if (stack_is_empty(stack)) {
+        on_error(CONCEPT_GENERAL_ERROR, "Stack is empty. Nothing to peek.", CONCEPT_STATE_ERROR, CONCEPT_WARN_EXITNOW);
+    }
+    return &stack->operand_stack[stack->top];
+}
+#endif
+
+// Unchecked stack access for eval() and the handlers. verify_procedures() has proven that every pop has an operand,
+// and PROCEDURE_ENTER() reserves each frame's proven maximum depth, so no access can leave the stack.
+// DEBUG builds keep the checks.
+#ifdef DEBUG
+#define stack_push_fast stack_push
+#define stack_pop_fast stack_pop
+#define stack_peek_fast stack_peek
+#else
+static inline void stack_push_fast(ConceptStack_t *stack, ConceptValue_t value) {
+    stack->operand_stack[++(stack->top)] = value;
+}
+
+static inline ConceptValue_t stack_pop_fast(ConceptStack_t *stack) {
+    return stack->operand_stack[(stack->top)--];
+}
+
+static inline ConceptValue_t *stack_peek_fast(ConceptStack_t *stack) {
+    return &stack->operand_stack[stack->top];
+}
+#endif
+
+/**
+ * Allocate an operand stack of bt_size values from the run region.
+ *
+ * @param stack ConceptStack_t*
+ * @param bt_size int32_t
+ * @return void
+ */
+void stack_alloc(ConceptStack_t *stack, int32_t bt_size);
+/**
+ * Reset a stack, its values go away with the run region.
+ *
+ * @param stack ConceptStack_t*
+ * @return void
+ */
+void stack_free(ConceptStack_t *stack);
+/**
+ * Allocate a frame stack for depth nested calls from the run region.
+ *
+ * @param frames ConceptFrameStack_t*
+ * @param depth int32_t
+ * @return void
+ */
+void frame_stack_alloc(ConceptFrameStack_t *frames, int32_t depth);
+/**
+ * Reset a frame stack.
+ *
+ * @param frames ConceptFrameStack_t*
+ * @return void
+ */
+void frame_stack_free(ConceptFrameStack_t *frames);
+
+// Stack handlers of the instructions, see opcodes.def
+void concept_iadd(ConceptStack_t *stack);
+void concept_idiv(ConceptStack_t *stack);
+void concept_imul(ConceptStack_t *stack);
+void concept_fadd(ConceptStack_t *stack);
+void concept_fdiv(ConceptStack_t *stack);
+void concept_fmul(ConceptStack_t *stack);
+void concept_ilt(ConceptStack_t *stack);
+void concept_ieq(ConceptStack_t *stack);
+void concept_igt(ConceptStack_t *stack);
+void concept_flt(ConceptStack_t *stack);
+void concept_feq(ConceptStack_t *stack);
+void concept_fgt(ConceptStack_t *stack);
+void concept_and(ConceptStack_t *stack);
+void concept_or(ConceptStack_t *stack);
+void concept_xor(ConceptStack_t *stack);
+void concept_ne(ConceptStack_t *stack);
+void concept_if(ConceptStack_t *stack);
+void concept_print(ConceptStack_t *stack);
+void concept_incr(ConceptStack_t *stack);
+void concept_decr(ConceptStack_t *stack);
+void concept_swap(ConceptStack_t *stack);
+void concept_dupl(ConceptStack_t *stack);
+void concept_scat(ConceptStack_t *stack);
+/**
+ * Print a value the way print shows it, without a newline.
+ *
+ * @param v const ConceptValue_t*
+ * @return void
+ */
+void print_value(const ConceptValue_t *v);
+
+/* ========================
+ * Statistics and profiling
+ * ========================
+ */
+
+typedef struct {
+    uint64_t opcode_counts[CONCEPT_OPCODE_MAX];
+    uint64_t opcode_ticks[CONCEPT_OPCODE_MAX];
+    uint64_t *procedure_calls;
+    uint64_t *procedure_instructions;
+    uint64_t *procedure_ticks;
+    int32_t procedure_count;
+    // the instruction being charged, -1 before the first one
+    int32_t last_opcode;
+    int32_t last_procedure;
+    uint64_t last_tick;
+    uint64_t start_tick;
+    uint64_t start_ns;
+    const char *tier;
+} ConceptStats_t;
+
+// Collected while the program runs, NULL otherwise
+extern ConceptStats_t *concept_stats;
+
+// Counted by every interpreter on entry to procedure p
+#define STATS_CALL(stats, p) \
+    do { \
+        if ((stats) != NULL) \
+            (stats)->procedure_calls[p]++; \
+    } while (0)
+
+// Nonzero while the profiler's timer runs; the interpreters publish their position only then
+extern volatile sig_atomic_t profiling;
+// Published by the interpreters, read by the profiler's signal handler
+extern volatile int32_t profile_procedure;
+extern volatile int32_t profile_pc;
+// profile_procedure while compiled code runs, which does not publish
+#define CONCEPT_PROFILE_JIT (-2)
+
+// Used by the interpreters, where profiled caches profiling
+#define PROFILE_PUBLISH(p, pc) \
+    do { \
+        if (profiled) { \
+            profile_procedure = (p); \
+            profile_pc = (pc); \
+        } \
+    } while (0)
+
+/* ========================
+ * Loader and engines
+ * ========================
+ */
+
+// Execution tiers selected on the command line
+#define CONCEPT_TIER_STACK 0 // eval()
+#define CONCEPT_TIER_REGISTER 1 // --register: reg_eval() on the code of translate_procedures()
+#define CONCEPT_TIER_JIT 2 // --jit: the same code compiled by jit_compile_procedures()
+#define CONCEPT_TIER_TIERED 3 // --tiered: eval(), hot procedures compiled in the background, see tier_start()
+
+// Calls plus backward jumps after which --tiered compiles a procedure
+#ifndef CONCEPT_TIER_THRESHOLD
+#define CONCEPT_TIER_THRESHOLD 1000
+#endif
+
+// Report files of --stats and --profile, NULL when not asked for
+extern char *stats_path;
+extern char *profile_path;
+
+/**
+ * Monotonic clock in nanoseconds.
+ *
+ * @return uint64_t
+ */
+uint64_t stats_now();
+/**
+ * Zeroed work memory for the loader, from scratch_arena: released all at once when the load is done or abandoned.
+ *
+ * @param count size_t
+ * @param size size_t
+ * @return void*
+ */
+void *scratch_calloc(size_t count, size_t size);
+/**
+ * Verify procedure p alone, see verify_procedures().
+ *
+ * @param p int32_t
+ * @param depths int32_t* receives the operand depth at every instruction, -1 where unreachable; may be NULL
+ * @return int32_t maximum operand depth
+ */
+int32_t verify_procedure(int32_t p, int32_t *depths);
+/**
+ * Load a source file or image and get it ready to run on the given tier: verified, counters cleared, translated
+ * (and compiled) or fused (and threaded), globals allocated. The JIT binds its code to the stack and frames.
+ *
+ * @param arg char* path of a .fng source or a .fngc image
+ * @param tier int32_t CONCEPT_TIER_*
+ * @param stack ConceptStack_t*
+ * @param frames ConceptFrameStack_t*
+ * @return void
+ */
+void load_program(char *arg, int32_t tier, ConceptStack_t *stack, ConceptFrameStack_t *frames);
+/**
+ * Unload the program: the program region and the image mapping.
+ *
+ * @return void
+ */
+void cleanup();
+/**
+ * Unmap the source file, once it is parsed or its parse was aborted.
+ *
+ * @return void
+ */
+void unmap_prog();
+/**
+ * Start the collector, with the run's stack and the globals as roots.
+ *
+ * @param stack ConceptStack_t*
+ * @return void
+ */
+void gc_start(ConceptStack_t *stack);
+/**
+ * Run procedure index on the stack interpreter. The stack holds its arguments on top; calls and returns stay
+ * inside, and the procedure's return value comes back.
+ *
+ * @param index int32_t
+ * @param stack ConceptStack_t*
+ * @param globals ConceptValue_t*
+ * @param frames ConceptFrameStack_t*
+ * @param start_by int32_t
+ * @return ConceptValue_t
+ */
+ConceptValue_t eval(int32_t index, ConceptStack_t *stack, ConceptValue_t *globals, ConceptFrameStack_t *frames,
+                    int32_t start_by);
+/**
+ * Load, run on the given tier and unload a program, as the Conceptum executable does.
+ *
+ * @param arg char*
+ * @param tier int32_t CONCEPT_TIER_*
+ * @return void
+ */
+void run(char *arg, int32_t tier);
+/**
+ * Parse a source file and write it as a precompiled .fngc image.
+ *
+ * @param source_path char*
+ * @param image_path char*
+ * @return void
+ */
+void assemble(char *source_path, char *image_path);
+#endif
@@ -0,0 +1,134 @@
+/*
+ * api_test.c
+ *
+ * Host program for the embedding API: loads tests/bytecodes/api.fng into libconceptum on one engine and checks
+ * repeated calls, the status of every kind of failure, and that the VM stays usable after each of them.
+ * Usage: ConceptumApiTest <stack|register|jit|tiered> <api.fng>
+ * Copyright (C) Alex Fang <ruijief@acm.org> 2016
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "conceptum.h"
+
+// Runtime errors report the exit status of the Conceptum executable, see CONCEPT_* in vm.h
+#define API_STATUS_EXITNOW 95 // HALT
+#define API_STATUS_ABORT 97 // division by zero
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("\nFAIL %s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static ConceptumValue_t int_value(int32_t i) {
+    ConceptumValue_t v;
+    v.type = CONCEPTUM_INT;
+    v.as.i = i;
+    return v;
+}
+
+static ConceptumValue_t float_value(float f) {
+    ConceptumValue_t v;
+    v.type = CONCEPTUM_FLOAT;
+    v.as.f = f;
+    return v;
+}
+
+static ConceptumValue_t string_value(const char *s) {
+    ConceptumValue_t v;
+    v.type = CONCEPTUM_STRING;
+    v.as.s = s;
+    return v;
+}
+
+static int32_t engine_named(const char *name) {
+    const char *engines[] = {"stack", "register", "jit", "tiered"};
+    for (int32_t e = 0; e < 4; e++)
+        if (!strcmp(name, engines[e]))
+            return e;
+    return -1;
+}
+
+// fib(20), often enough for the tiered engine to compile it on the way
+static void check_fib(ConceptumVM_t *vm) {
+    int32_t fib = conceptum_procedure(vm, "fib");
+    CHECK(fib >= 0);
+    for (int32_t k = 0; k < 20; k++) {
+        ConceptumValue_t arg = int_value(20), result = int_value(0);
+        CHECK(conceptum_call(vm, fib, &arg, 1, &result) == CONCEPTUM_OK);
+        CHECK(result.type == CONCEPTUM_INT && result.as.i == 6765);
+    }
+}
+
+int main(int argc, char **argv) {
+    int32_t engine = argc == 3 ? engine_named(argv[1]) : -1;
+    if (engine < 0) {
+        printf("Usage: %s <stack|register|jit|tiered> <api.fng>\n", argv[0]);
+        return 2;
+    }
+    const char *path = argv[2];
+    ConceptumValue_t args[2], result;
+
+    ConceptumVM_t *vm = conceptum_create(engine);
+    CHECK(vm != NULL);
+    if (vm == NULL)
+        return 1;
+    CHECK(conceptum_create(engine) == NULL); // one VM at a time
+    CHECK(conceptum_invoke(vm, "fib", NULL, 0, &result) == CONCEPTUM_NOT_LOADED);
+    CHECK(conceptum_load(vm, "tests/bytecodes/no_such_program.fng") != CONCEPTUM_OK);
+    CHECK(conceptum_invoke(vm, "fib", NULL, 0, &result) == CONCEPTUM_NOT_LOADED);
+
+    CHECK(conceptum_load(vm, path) == CONCEPTUM_OK);
+    check_fib(vm);
+
+    args[0] = float_value(1.5f);
+    args[1] = float_value(4.0f);
+    CHECK(conceptum_invoke(vm, "fmul", args, 2, &result) == CONCEPTUM_OK);
+    CHECK(result.type == CONCEPTUM_FLOAT && result.as.f == 6.0f);
+    args[0] = string_value("there");
+    CHECK(conceptum_invoke(vm, "greet", args, 1, &result) == CONCEPTUM_OK);
+    CHECK(result.type == CONCEPTUM_STRING && !strcmp(result.as.s, "hi_there"));
+
+    // globals keep their values from call to call
+    args[0] = int_value(42);
+    CHECK(conceptum_invoke(vm, "setn", args, 1, &result) == CONCEPTUM_OK);
+    CHECK(conceptum_invoke(vm, "getn", NULL, 0, &result) == CONCEPTUM_OK);
+    CHECK(result.type == CONCEPTUM_INT && result.as.i == 42);
+
+    // errors the API reports itself
+    CHECK(conceptum_invoke(vm, "no_such_procedure", NULL, 0, &result) == CONCEPTUM_NO_PROCEDURE);
+    CHECK(conceptum_call(vm, 1000, NULL, 0, &result) == CONCEPTUM_NO_PROCEDURE);
+    CHECK(conceptum_invoke(vm, "div", args, 1, &result) == CONCEPTUM_BAD_ARGUMENTS);
+
+    // runtime errors abort the call only
+    args[0] = int_value(7);
+    args[1] = int_value(0);
+    CHECK(conceptum_invoke(vm, "div", args, 2, &result) == API_STATUS_ABORT);
+    args[1] = int_value(2);
+    CHECK(conceptum_invoke(vm, "div", args, 2, &result) == CONCEPTUM_OK);
+    CHECK(result.type == CONCEPTUM_INT && result.as.i == 3);
+    CHECK(conceptum_invoke(vm, "stop", NULL, 0, &result) == API_STATUS_EXITNOW);
+    check_fib(vm);
+    CHECK(conceptum_invoke(vm, "getn", NULL, 0, &result) == CONCEPTUM_OK);
+    CHECK(result.type == CONCEPTUM_INT && result.as.i == 42);
+
+    // a reload starts over with fresh globals
+    CHECK(conceptum_load(vm, path) == CONCEPTUM_OK);
+    CHECK(conceptum_invoke(vm, "getn", NULL, 0, &result) == CONCEPTUM_OK);
+    CHECK(result.type == CONCEPTUM_VOID);
+    check_fib(vm);
+
+    conceptum_destroy(vm);
+    vm = conceptum_create(engine);
+    CHECK(vm != NULL);
+    conceptum_destroy(vm);
+
+    printf("\n%s: %d failures\n", argv[1], failures);
+    return failures != 0;
+}
@@ -0,0 +1,141 @@
+/*
+ * bench.c
+ *
+ * Benchmark runner behind the `bench` target.
+ * Runs every workload under a Conceptum binary and prints its instruction count, wall time and instructions per second.
+ * Copyright (C) Alex Fang <ruijief@acm.org> 2016
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_RUNS 100
+#define DEFAULT_RUNS 5
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// Run argv with its output discarded; returns the wall time in ns, or 0 if it did not exit cleanly
+static uint64_t run(char **argv) {
+    uint64_t start = now_ns();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) {
+            dup2(null, STDOUT_FILENO);
+            close(null);
+        }
+        execv(argv[0], argv);
+        perror(argv[0]);
+        _exit(127);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) < 0) {
+        perror("waitpid");
+        exit(1);
+    }
+    uint64_t elapsed = now_ns() - start;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        return 0;
+    return elapsed > 0 ? elapsed : 1;
+}
+
+// Instructions the stack interpreter executes for file, read back from a --stats report
+static uint64_t count_instructions(char *binary, char *file) {
+    char report[] = "conceptum-bench-XXXXXX";
+    int fd = mkstemp(report);
+    if (fd < 0) {
+        perror("mkstemp");
+        exit(1);
+    }
+    close(fd);
+
+    char *argv[] = {binary, "--stats", report, file, NULL};
+    uint64_t instructions = 0;
+    if (run(argv) != 0) {
+        FILE *fp = fopen(report, "r");
+        char line[256];
+        while (fp != NULL && fgets(line, sizeof(line), fp) != NULL) {
+            char *field = strstr(line, "\"instructions\": ");
+            if (field != NULL) { // the program total comes before the per-opcode and per-procedure entries
+                instructions = strtoull(field + strlen("\"instructions\": "), NULL, 10);
+                break;
+            }
+        }
+        if (fp != NULL)
+            fclose(fp);
+    }
+    unlink(report);
+    return instructions;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    int runs = DEFAULT_RUNS;
+    char *tier = NULL;
+    int arg = 1;
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if (strcmp(argv[arg], "--runs") == 0 && arg + 1 < argc) {
+            runs = atoi(argv[arg + 1]);
+            arg += 2;
+        } else if (strcmp(argv[arg], "--register") == 0 || strcmp(argv[arg], "--jit") == 0 ||
+                   strcmp(argv[arg], "--tiered") == 0) {
+            tier = argv[arg++];
+        } else {
+            break;
+        }
+    }
+    if (argc - arg < 2 || runs < 1 || runs > MAX_RUNS) {
+        fprintf(stderr, "Usage: %s [--runs N] [--register | --jit | --tiered] <Conceptum> <file.fng>...\n", argv[0]);
+        return 1;
+    }
+    char *binary = argv[arg++];
+
+    printf("%-16s %14s %12s %12s %12s\n", "workload", "instructions", "best ms", "median ms", "Minstr/s");
+    int failed = 0;
+    for (; arg < argc; arg++) {
+        char *file = argv[arg];
+        char *name = strrchr(file, '/') != NULL ? strrchr(file, '/') + 1 : file;
+
+        // the stack interpreter's count is the yardstick for every tier, so instructions per second stay comparable
+        uint64_t instructions = count_instructions(binary, file);
+
+        char *timed[] = {binary, tier != NULL ? tier : file, file, NULL};
+        if (tier == NULL)
+            timed[2] = NULL;
+        uint64_t times[MAX_RUNS];
+        int ok = instructions != 0;
+        for (int r = 0; ok && r < runs; r++)
+            ok = (times[r] = run(timed)) != 0;
+        if (!ok) {
+            printf("%-16s failed\n", name);
+            failed = 1;
+            continue;
+        }
+
+        qsort(times, (size_t) runs, sizeof(times[0]), compare_u64);
+        uint64_t best = times[0], median = times[runs / 2];
+        printf("%-16s %14" PRIu64 " %12.1f %12.1f %12.1f\n", name, instructions, best / 1e6, median / 1e6,
+               instructions * 1e3 / best);
+    }
+    return failed;
+}
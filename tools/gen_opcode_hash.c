@@ -0,0 +1,67 @@
+/*
+ * gen_opcode_hash.c
+ *
+ * Build-time generator of the perfect hash table over the mnemonics in opcodes.def.
+ * Prints opcode_hash.h to stdout.
+ * Copyright (C) Alex Fang <ruijief@acm.org> 2016
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/opcodes.h"
+
+typedef struct {
+    const char *mnemonic;
+    int code;
+} Key_t;
+
+static const Key_t keys[] = {
+#define CONCEPT_OPCODE(name, mnemonic, code, payload, pops, pushes, handler) {mnemonic, code},
+#define CONCEPT_ALIAS(mnemonic, name) {mnemonic, CONCEPT_##name},
+#define CONCEPT_SUPER(name, mnemonic, code, payload, pops, pushes, first, second) // not parseable
+#include "../src/opcodes.def"
+};
+
+#define KEY_COUNT (sizeof(keys) / sizeof(keys[0]))
+#define MAX_SEEDS 1000000
+
+int main() {
+    for (uint32_t size = 1; size <= 4096; size <<= 1) {
+        if (size < KEY_COUNT)
+            continue;
+        int *slots = malloc(sizeof(int) * size);
+
+        for (uint32_t seed = 0; seed < MAX_SEEDS; seed++) {
+            int collision = 0;
+            for (uint32_t s = 0; s < size; s++) slots[s] = -1;
+
+            for (size_t k = 0; k < KEY_COUNT && !collision; k++) {
+                uint32_t h = concept_opcode_hash(keys[k].mnemonic, strlen(keys[k].mnemonic), seed) & (size - 1);
+                if (slots[h] >= 0) collision = 1;
+                else slots[h] = (int) k;
+            }
+            if (collision)
+                continue;
+
+            printf("/* Generated by gen_opcode_hash from opcodes.def. Do not edit. */\n\n");
+            printf("#ifndef OPCODE_HASH_H_\n#define OPCODE_HASH_H_\n\n");
+            printf("#define CONCEPT_OPCODE_HASH_SEED %uu\n", seed);
+            printf("#define CONCEPT_OPCODE_HASH_SIZE %u\n\n", size);
+            printf("static const ConceptOpcodeSlot_t concept_opcode_hash_slots[CONCEPT_OPCODE_HASH_SIZE] = {\n");
+            for (uint32_t s = 0; s < size; s++) {
+                if (slots[s] < 0)
+                    printf("        {NULL, -1},\n");
+                else
+                    printf("        {\"%s\", %d},\n", keys[slots[s]].mnemonic, keys[slots[s]].code);
+            }
+            printf("};\n\n#endif\n");
+            free(slots);
+            return 0;
+        }
+        free(slots);
+    }
+    fprintf(stderr, "gen_opcode_hash: no perfect hash found\n");
+    return 1;
+}
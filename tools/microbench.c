@@ -0,0 +1,224 @@
+/*
+ * microbench.c
+ *
+ * Opcode-level microbenchmarks behind the `microbench` target: single handlers, stack pushes and pops and the
+ * CALL path, timed in isolation with warm caches and randomized operands, reported in ns/op with their spread.
+ * Linked against vm.c like the Conceptum executable; the stack helpers are the inline ones of vm.h.
+ * Copyright (C) Alex Fang <ruijief@acm.org> 2016
+ */
+
+#define _POSIX_C_SOURCE 200809L // mkstemp()
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "vm.h"
+
+// Every benchmark runs MICRO_WARMUP untimed samples, then MICRO_SAMPLES timed ones of MICRO_OPS operations each
+#ifndef MICRO_SAMPLES
+#define MICRO_SAMPLES 25
+#endif
+#ifndef MICRO_WARMUP
+#define MICRO_WARMUP 3
+#endif
+#ifndef MICRO_OPS
+#define MICRO_OPS (1 << 20)
+#endif
+#define MICRO_OPERANDS 4096 // power of two, cycled through by the handler benchmarks
+
+// Keep the compiler from merging or dropping the stack traffic between operations
+#ifdef __GNUC__
+#define MICRO_CLOBBER() __asm__ volatile("" ::: "memory")
+#else
+#define MICRO_CLOBBER()
+#endif
+
+static int32_t int_operands[2][MICRO_OPERANDS];
+static float float_operands[2][MICRO_OPERANDS];
+static volatile int64_t sink;
+
+static ConceptStack_t micro_stack;
+static ConceptFrameStack_t micro_frames;
+static int32_t micro_depth_procedure;
+
+// xorshift32 with a fixed seed, so every run sees the same operands
+static uint32_t micro_random() {
+    static uint32_t state = 2463534242u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void fill_operands() {
+    for (int32_t k = 0; k < MICRO_OPERANDS; k++)
+        for (int32_t side = 0; side < 2; side++) {
+            int_operands[side][k] = (int32_t) (micro_random() >> 2) - (1 << 29); // sums never overflow
+            float_operands[side][k] = 0.5f + (float) (micro_random() >> 8) / (float) (1 << 24) * 1.5f;
+        }
+}
+
+// Fill the stack up to depth values, so the operations under test work at that height
+static void stack_fill(int32_t depth) {
+    micro_stack.top = -1;
+    for (int32_t k = 0; k < depth; k++)
+        stack_push_fast(&micro_stack, value_int(k));
+}
+
+// One benchmark body: prepare the state for param, then perform ops operations; returns the operations done
+typedef int64_t (*ConceptMicroBody_t)(int32_t param, int64_t ops);
+
+static int64_t bench_push_pop(int32_t depth, int64_t ops) {
+    stack_fill(depth);
+    int64_t acc = 0;
+    for (int64_t k = 0; k < ops; k++) {
+        stack_push_fast(&micro_stack, value_int(int_operands[0][k & (MICRO_OPERANDS - 1)]));
+        MICRO_CLOBBER();
+        acc += stack_pop_fast(&micro_stack).as.i;
+        MICRO_CLOBBER();
+    }
+    sink = acc;
+    return ops;
+}
+
+static int64_t bench_iadd(int32_t depth, int64_t ops) {
+    stack_fill(depth);
+    int64_t acc = 0;
+    for (int64_t k = 0; k < ops; k++) {
+        stack_push_fast(&micro_stack, value_int(int_operands[0][k & (MICRO_OPERANDS - 1)]));
+        stack_push_fast(&micro_stack, value_int(int_operands[1][k & (MICRO_OPERANDS - 1)]));
+        MICRO_CLOBBER();
+        concept_iadd(&micro_stack);
+        MICRO_CLOBBER();
+        acc += stack_pop_fast(&micro_stack).as.i;
+    }
+    sink = acc;
+    return ops;
+}
+
+static int64_t bench_fmul(int32_t depth, int64_t ops) {
+    stack_fill(depth);
+    float acc = 0;
+    for (int64_t k = 0; k < ops; k++) {
+        stack_push_fast(&micro_stack, value_float(float_operands[0][k & (MICRO_OPERANDS - 1)]));
+        stack_push_fast(&micro_stack, value_float(float_operands[1][k & (MICRO_OPERANDS - 1)]));
+        MICRO_CLOBBER();
+        concept_fmul(&micro_stack);
+        MICRO_CLOBBER();
+        acc += stack_pop_fast(&micro_stack).as.f;
+    }
+    sink = (int64_t) acc;
+    return ops;
+}
+
+// Recursive descents of depth frames through eval(): every level is one CALL and one RET plus the body around them
+static int64_t bench_call(int32_t depth, int64_t ops) {
+    int64_t rounds = ops / depth;
+    int64_t acc = 0;
+    micro_stack.top = -1;
+    for (int64_t k = 0; k < rounds; k++) {
+        stack_push_fast(&micro_stack, value_int(depth));
+        acc += eval(micro_depth_procedure, &micro_stack, global_table, &micro_frames, 0).as.i;
+    }
+    sink = acc;
+    return rounds * depth;
+}
+
+static const char *micro_call_source =
+        ".def main: args=0, locals=0\n"
+        "    iconst 0\n"
+        "    ret\n"
+        ".def depth: args=1, locals=0    ; int depth(n), n frames deep, not a tail call\n"
+        "    iconst 0\n"
+        "    load 0\n"
+        "    ieq\n"
+        "    if_icmple rec\n"
+        "    iconst 0\n"
+        "    ret\n"
+        "rec:\n"
+        "    load 0\n"
+        "    dec\n"
+        "    call depth\n"
+        "    inc\n"
+        "    ret\n";
+
+// Assemble the CALL benchmark's program through the regular loader
+static void load_call_program() {
+    char path[] = "conceptum-microbench-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, micro_call_source, strlen(micro_call_source)) < 0) {
+        perror("microbench");
+        exit(1);
+    }
+    close(fd);
+    load_program(path, CONCEPT_TIER_STACK, &micro_stack, &micro_frames);
+    unlink(path);
+    micro_depth_procedure = -1;
+    for (int32_t p = 0; p < procedure_call_table_length; p++)
+        if (!strcmp(procedure_call_table[p], "depth"))
+            micro_depth_procedure = p;
+    if (micro_depth_procedure < 0) {
+        fprintf(stderr, "microbench: procedure depth missing\n");
+        exit(1);
+    }
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static void measure(const char *name, int32_t param, ConceptMicroBody_t body, const char *filter) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s/%d", name, param);
+    if (filter != NULL && strstr(label, filter) == NULL)
+        return;
+
+    for (int32_t s = 0; s < MICRO_WARMUP; s++)
+        body(param, MICRO_OPS);
+
+    double samples[MICRO_SAMPLES], sum = 0;
+    for (int32_t s = 0; s < MICRO_SAMPLES; s++) {
+        uint64_t start = stats_now();
+        int64_t done = body(param, MICRO_OPS);
+        samples[s] = (double) (stats_now() - start) / (double) done;
+        sum += samples[s];
+    }
+    double mean = sum / MICRO_SAMPLES, variance = 0;
+    for (int32_t s = 0; s < MICRO_SAMPLES; s++)
+        variance += (samples[s] - mean) * (samples[s] - mean);
+    variance /= MICRO_SAMPLES - 1;
+    qsort(samples, MICRO_SAMPLES, sizeof(samples[0]), compare_double);
+
+    printf("%-20s %10.3f %10.3f %10.3f %10.3f\n", label, samples[0], samples[MICRO_SAMPLES / 2], mean, sqrt(variance));
+}
+
+int32_t main(int32_t argc, char **argv) {
+    const char *filter = argc > 1 ? argv[1] : NULL; // only benchmarks whose name/param contains it
+
+    stack_alloc(&micro_stack, CONCEPTFP_MAX_LENGTH);
+    frame_stack_alloc(&micro_frames, CONCEPTREC_MAX_LENGTH);
+    fill_operands();
+    load_call_program();
+
+    static const int32_t depths[] = {0, 1024, CONCEPTFP_MAX_LENGTH - 16}; // operand stack heights
+    static const int32_t call_depths[] = {1, 16, 256, 4096}; // frames per descent
+
+    printf("%-20s %10s %10s %10s %10s\n", "ns/op", "min", "median", "mean", "stddev");
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++)
+        measure("push+pop", depths[d], bench_push_pop, filter);
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++)
+        measure("iadd", depths[d], bench_iadd, filter);
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]); d++)
+        measure("fmul", depths[d], bench_fmul, filter);
+    for (size_t d = 0; d < sizeof(call_depths) / sizeof(call_depths[0]); d++)
+        measure("call", call_depths[d], bench_call, filter);
+
+    frame_stack_free(&micro_frames);
+    stack_free(&micro_stack);
+    arena_free(&run_arena);
+    cleanup();
+    return 0;
+}